@@ -0,0 +1,122 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Build-time code generator: loads a root file with its includes and writes a
+// header with C++ structs described by a schema, see PtreeCodegen.h.
+// Used by the ptree_codegen() CMake function, see CMakeLists.txt.
+//
+// Usage: PtreeCodegen [-n <namespace>] [-d <depfile>] <schema file> <root file> <header>
+//   -n  namespace of the structs (default: ptree_config)
+//   -d  write a Makefile depfile listing the files the tree was loaded from
+// Exit code is 1 if schema or root failed to load or did not match.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+
+#include <print>
+#include <PtreeLoader.h>
+#include <PtreeCodegen.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+template<ptree_loader::PtreeFileFormat T>
+ptree_loader::LoadResult LoadTree( const std::filesystem::path &fsPath, boost::property_tree::ptree &pt,
+                                   const std::filesystem::path &fsHeader, const std::filesystem::path &fsDepfile )
+{
+    ptree_loader::PtreeLoader<T> ptLoader( pt );
+
+    auto result{ ptLoader.TryLoad( fsPath ) };
+
+    if ( result && !fsDepfile.empty() && !ptLoader.WriteDepfile( fsDepfile, fsHeader.string() ) )
+    {
+        return std::unexpected( std::vector<ptree_loader::ParseError>{
+            { fsDepfile.string(), 0, 0, "cannot write depfile" } } );
+    }
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+ptree_loader::LoadResult Load( const std::filesystem::path &fsPath, boost::property_tree::ptree &pt,
+                               const std::filesystem::path &fsHeader = {}, const std::filesystem::path &fsDepfile = {} )
+{
+    const std::string ext{ fsPath.extension().string() };
+
+    if ( ext == ".xml" )
+    {
+        return LoadTree<ptree_loader::PtreeFileFormat::xml>( fsPath, pt, fsHeader, fsDepfile );
+    }
+    else if ( ext == ".json" )
+    {
+        return LoadTree<ptree_loader::PtreeFileFormat::json>( fsPath, pt, fsHeader, fsDepfile );
+    }
+    else if ( ext == ".info" )
+    {
+        return LoadTree<ptree_loader::PtreeFileFormat::info>( fsPath, pt, fsHeader, fsDepfile );
+    }
+
+    return std::unexpected( std::vector<ptree_loader::ParseError>{
+        { fsPath.string(), 0, 0, "unknown file format" } } );
+}
+
+// -----------------------------------------------------------------------------
+// main()
+// -----------------------------------------------------------------------------
+int main( int argc, char *argv[] )
+{
+    std::vector<std::filesystem::path> paths;
+    std::string                        ns{ "ptree_config" };
+    std::filesystem::path              fsDepfile;
+
+    for ( int i{ 1 }; i < argc; ++i )
+    {
+        const std::string arg{ argv[i] };
+
+        if ( arg == "-n" && i + 1 < argc )
+        {
+            ns = argv[++i];
+        }
+        else if ( arg == "-d" && i + 1 < argc )
+        {
+            fsDepfile = argv[++i];
+        }
+        else
+        {
+            paths.emplace_back( arg );
+        }
+    }
+
+    if ( paths.size() != 3 )
+    {
+        std::print( "Usage: PtreeCodegen [-n <namespace>] [-d <depfile>] <schema file> <root file> <header>\n" );
+        return paths.empty() ? 0 : 1;
+    }
+
+    boost::property_tree::ptree schema;
+    boost::property_tree::ptree pt;
+
+    // Schema includes are not tracked by the depfile, the schema itself is a dependency of the build rule
+    for ( const auto& result : { Load( paths[0], schema ), Load( paths[1], pt, paths[2], fsDepfile ) } )
+    {
+        if ( !result )
+        {
+            for ( const auto& error : result.error() )
+            {
+                std::print( "FAILED: {}\n", error.ToString() );
+            }
+            return 1;
+        }
+    }
+
+    const std::string source{ paths[0].filename().string() + " and " + paths[1].filename().string() };
+
+    if ( const auto error{ ptree_loader::WriteStructs( schema, pt, paths[2], ns, source ) } )
+    {
+        std::print( "FAILED: {}\n{}", paths[1].string(), *error );
+        return 1;
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,118 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Build-time embedder: loads a root file with its includes and writes a header
+// with the tree as constexpr tables, see PtreeEmbedded.h.
+// Used by the ptree_embed() CMake function, see CMakeLists.txt.
+//
+// Usage: PtreeEmbedder [-n <namespace>] [-d <depfile>] <root file> <header>
+//   -n  namespace of the tables (default: embedded_ptree)
+//   -d  write a Makefile depfile listing the files the tree was loaded from
+// Exit code is 1 if the root failed to load or the header was not written.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+
+#include <print>
+#include <PtreeLoader.h>
+#include <PtreeEmbedded.h>
+#include <PtreeCodegen.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+template<ptree_loader::PtreeFileFormat T>
+int EmbedRoot( const std::filesystem::path &fsPath, const std::filesystem::path &fsHeader,
+               const std::string &ns, const std::filesystem::path &fsDepfile )
+{
+    boost::property_tree::ptree pt;
+    ptree_loader::PtreeLoader<T> ptLoader( pt );
+
+    const auto result{ ptLoader.TryLoad( fsPath ) };
+
+    if ( !result )
+    {
+        std::print( "FAILED: {}\n", fsPath.string() );
+
+        for ( const auto& error : result.error() )
+        {
+            std::print( "    {}\n", error.ToString() );
+        }
+        return 1;
+    }
+
+    if ( !ptree_loader::WriteEmbedded( pt, fsHeader, ns, fsPath.filename().string() ) )
+    {
+        std::print( "FAILED: cannot write {}\n", fsHeader.string() );
+        return 1;
+    }
+
+    if ( !fsDepfile.empty() && !ptLoader.WriteDepfile( fsDepfile, fsHeader.string() ) )
+    {
+        std::print( "FAILED: cannot write {}\n", fsDepfile.string() );
+        return 1;
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// main()
+// -----------------------------------------------------------------------------
+int main( int argc, char *argv[] )
+{
+    std::vector<std::filesystem::path> paths;
+    std::string                        ns{ "embedded_ptree" };
+    std::filesystem::path              fsDepfile;
+
+    for ( int i{ 1 }; i < argc; ++i )
+    {
+        const std::string arg{ argv[i] };
+
+        if ( arg == "-n" && i + 1 < argc )
+        {
+            ns = argv[++i];
+        }
+        else if ( arg == "-d" && i + 1 < argc )
+        {
+            fsDepfile = argv[++i];
+        }
+        else
+        {
+            paths.emplace_back( arg );
+        }
+    }
+
+    if ( paths.size() != 2 )
+    {
+        std::print( "Usage: PtreeEmbedder [-n <namespace>] [-d <depfile>] <root file> <header>\n" );
+        return paths.empty() ? 0 : 1;
+    }
+
+    // Same rules as the namespace of generated structs
+    if ( const auto error{ ptree_loader::detail::codegen::NamespaceError( ns ) } )
+    {
+        std::print( "FAILED: namespace \"{}\" {}\n", ns, *error );
+        return 1;
+    }
+
+    const std::string ext{ paths[0].extension().string() };
+
+    if ( ext == ".xml" )
+    {
+        return EmbedRoot<ptree_loader::PtreeFileFormat::xml>( paths[0], paths[1], ns, fsDepfile );
+    }
+    else if ( ext == ".json" )
+    {
+        return EmbedRoot<ptree_loader::PtreeFileFormat::json>( paths[0], paths[1], ns, fsDepfile );
+    }
+    else if ( ext == ".info" )
+    {
+        return EmbedRoot<ptree_loader::PtreeFileFormat::info>( paths[0], paths[1], ns, fsDepfile );
+    }
+
+    std::print( "FAILED: {}: unknown file format\n", paths[0].string() );
+    return 1;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,15 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Explicit instantiation of PtreeLoader for INFO files, part of the
+// ptree_loader library, see CMakeLists.txt.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+
+#include <PtreeLoaderInfo.h>
+
+// -----------------------------------------------------------------------------
+template class ptree_loader::PtreeLoader<ptree_loader::PtreeFileFormat::info>;
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,15 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Explicit instantiation of PtreeLoader for XML files, part of the
+// ptree_loader library, see CMakeLists.txt.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+
+#include <PtreeLoaderXml.h>
+
+// -----------------------------------------------------------------------------
+template class ptree_loader::PtreeLoader<ptree_loader::PtreeFileFormat::xml>;
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,513 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Read-only binary ptree format that is queried in place from a memory mapped
+// file, without deserialization. Opening costs the same regardless of size
+// and the mapped pages are shared by all processes using the same file.
+//
+// Format, version 1. All integers are little-endian uint32, all offsets are
+// counted from the start of the file.
+//
+//   Header        24 bytes
+//     char[8]     magic "PTREEBIN"
+//     uint32      version
+//     uint32      node count
+//     uint32      root node offset
+//     uint32      file size
+//   Nodes         28 bytes each, in pre-order
+//     uint32      key offset, key length      (string pool)
+//     uint32      data offset, data length    (string pool)
+//     uint32      child count
+//     uint32      children offset             (child table)
+//     uint32      sorted offset               (sorted table)
+//   Child tables  child count x node offset, in document order
+//   Sorted tables child count x index into the child table, ordered by key,
+//                 equal keys in document order
+//   String pool   key and data bytes, identical strings are stored once
+//
+// Leaf nodes have zero children and zero table offsets.
+// Open() checks the header only, Validate() checks the whole file before
+// files from untrusted sources are queried.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeBinary_H
+#define PtreeBinary_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <optional>
+#include <expected>
+#include <fstream>
+#include <filesystem>
+#include <limits>
+#include <cstdint>
+#include <boost/property_tree/ptree.hpp>
+#include "PtreeMappedFile.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+namespace bpt = boost::property_tree;
+
+// -----------------------------------------------------------------------------
+namespace detail::binary
+{
+inline constexpr char          magic[8]{ 'P', 'T', 'R', 'E', 'E', 'B', 'I', 'N' };
+inline constexpr std::uint32_t version{ 1 };
+inline constexpr std::uint32_t headerSize{ 24 };
+inline constexpr std::uint32_t nodeSize{ 28 };
+inline constexpr std::size_t   maxSize{ std::numeric_limits<std::uint32_t>::max() };
+
+inline std::uint32_t Load32( const char* p )
+{
+    const auto* u{ reinterpret_cast<const unsigned char*>( p ) };
+    return std::uint32_t( u[0] ) | std::uint32_t( u[1] ) << 8 | std::uint32_t( u[2] ) << 16 | std::uint32_t( u[3] ) << 24;
+}
+
+inline void Store32( std::string& out, std::size_t pos, std::uint32_t v )
+{
+    out[pos]     = static_cast<char>( v );
+    out[pos + 1] = static_cast<char>( v >> 8 );
+    out[pos + 2] = static_cast<char>( v >> 16 );
+    out[pos + 3] = static_cast<char>( v >> 24 );
+}
+} // namespace detail::binary
+
+// -----------------------------------------------------------------------------
+// BinaryNode : view of one node in a mapped binary ptree
+// -----------------------------------------------------------------------------
+class BinaryNode
+{
+public:
+    BinaryNode( const char* base, std::uint32_t offset ) : base( base ), node( base + offset ) {}
+
+    std::string_view Key() const  { return String( 0 ); }
+    std::string_view Data() const { return String( 8 ); }
+    std::size_t      Size() const { return Field( 16 ); }
+    bool             Empty() const { return Size() == 0; }
+
+    /// Child in document order
+    BinaryNode Child( std::size_t i ) const
+    {
+        return { base, detail::binary::Load32( base + Field( 20 ) + 4 * i ) };
+    }
+
+    /// First child with key, binary search
+    std::optional<BinaryNode> Find( std::string_view key ) const;
+
+    /// Number of children with key
+    std::size_t Count( std::string_view key ) const;
+
+    /// Descendant by path
+    /// @param path Keys separated by separator, empty path is this node
+    std::optional<BinaryNode> FindPath( std::string_view path, char separator = '.' ) const;
+
+    /// Copy subtree into a ptree
+    bpt::ptree ToPtree() const;
+
+private:
+    std::uint32_t    Field( std::size_t pos ) const { return detail::binary::Load32( node + pos ); }
+    std::string_view String( std::size_t pos ) const { return { base + Field( pos ), Field( pos + 4 ) }; }
+
+    /// Key of the child at position i of the sorted table
+    std::string_view SortedKey( std::size_t i ) const
+    {
+        const std::uint32_t index{ detail::binary::Load32( base + Field( 24 ) + 4 * i ) };
+        return Child( index ).Key();
+    }
+
+    /// First position in the sorted table with key not less than key
+    std::size_t LowerBound( std::string_view key ) const;
+
+    const char* base;
+    const char* node;
+};
+
+// -----------------------------------------------------------------------------
+// BinaryPtree : mapped binary ptree file
+// -----------------------------------------------------------------------------
+class BinaryPtree
+{
+public:
+    /// Map binary ptree file, only the header is validated
+    /// @return Mapped file or error message
+    static std::expected<BinaryPtree, std::string> Open( const std::filesystem::path& fsPath );
+
+    /// Check the offsets and lengths of every node against the mapped size, O(file size)
+    /// Children must follow their parent, so a valid file has no cycles.
+    /// @return Nothing if queries stay within the file, otherwise error message
+    std::expected<void, std::string> Validate() const;
+
+    BinaryNode Root() const
+    {
+        const std::string_view view{ file.View() };
+        return { view.data(), detail::binary::Load32( view.data() + 16 ) };
+    }
+
+    /// Descendant of the root by dotted path
+    std::optional<BinaryNode> Find( std::string_view path, char separator = '.' ) const
+    {
+        return Root().FindPath( path, separator );
+    }
+
+    /// Data of the descendant of the root by dotted path
+    std::optional<std::string_view> GetData( std::string_view path, char separator = '.' ) const
+    {
+        const auto node{ Find( path, separator ) };
+        return node ? std::optional( node->Data() ) : std::nullopt;
+    }
+
+private:
+    MappedFile file;
+};
+
+// -----------------------------------------------------------------------------
+// Writer
+// -----------------------------------------------------------------------------
+/// Serialize ptree into binary format
+/// @return Serialized ptree or error message if it does not fit the 4 GiB the offsets can address
+inline std::expected<std::string, std::string> SerializeBinary( const bpt::ptree& pt );
+
+/// Write ptree to file in binary format
+/// @return false if the ptree is too large or the file could not be written
+inline bool WriteBinary( const bpt::ptree& pt, const std::filesystem::path& fsPath );
+
+// -----------------------------------------------------------------------------
+// BinaryNode definition
+// -----------------------------------------------------------------------------
+inline std::size_t BinaryNode::LowerBound( std::string_view key ) const
+{
+    std::size_t first{ 0 };
+    std::size_t count{ Size() };
+
+    while ( count > 0 )
+    {
+        const std::size_t step{ count / 2 };
+
+        if ( SortedKey( first + step ) < key )
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+    return first;
+}
+
+// -----------------------------------------------------------------------------
+inline std::optional<BinaryNode> BinaryNode::Find( std::string_view key ) const
+{
+    const std::size_t pos{ LowerBound( key ) };
+
+    if ( pos == Size() || SortedKey( pos ) != key )
+    {
+        return std::nullopt;
+    }
+    return Child( detail::binary::Load32( base + Field( 24 ) + 4 * pos ) );
+}
+
+// -----------------------------------------------------------------------------
+inline std::size_t BinaryNode::Count( std::string_view key ) const
+{
+    std::size_t count{ 0 };
+
+    for ( std::size_t pos{ LowerBound( key ) }; pos < Size() && SortedKey( pos ) == key; ++pos )
+    {
+        ++count;
+    }
+    return count;
+}
+
+// -----------------------------------------------------------------------------
+inline std::optional<BinaryNode> BinaryNode::FindPath( std::string_view path, char separator ) const
+{
+    std::optional<BinaryNode> current{ *this };
+
+    while ( current && !path.empty() )
+    {
+        const std::size_t sep{ path.find( separator ) };
+
+        current = current->Find( path.substr( 0, sep ) );
+        path    = sep == std::string_view::npos ? std::string_view() : path.substr( sep + 1 );
+    }
+    return current;
+}
+
+// -----------------------------------------------------------------------------
+inline bpt::ptree BinaryNode::ToPtree() const
+{
+    bpt::ptree pt{ std::string( Data() ) };
+
+    for ( std::size_t i{ 0 }; i < Size(); ++i )
+    {
+        const BinaryNode child{ Child( i ) };
+        pt.push_back( { std::string( child.Key() ), child.ToPtree() } );
+    }
+    return pt;
+}
+
+// -----------------------------------------------------------------------------
+// BinaryPtree definition
+// -----------------------------------------------------------------------------
+inline std::expected<BinaryPtree, std::string> BinaryPtree::Open( const std::filesystem::path& fsPath )
+{
+    using namespace detail::binary;
+
+    BinaryPtree result;
+
+    if ( !result.file.Open( fsPath ) )
+    {
+        return std::unexpected( "cannot map file " + fsPath.string() );
+    }
+
+    const std::string_view view{ result.file.View() };
+
+    if ( view.size() < headerSize || !std::equal( std::begin( magic ), std::end( magic ), view.data() ) )
+    {
+        return std::unexpected( "not a binary ptree file " + fsPath.string() );
+    }
+
+    if ( Load32( view.data() + 8 ) != version )
+    {
+        return std::unexpected( "unsupported binary ptree version in " + fsPath.string() );
+    }
+
+    if ( Load32( view.data() + 20 ) != view.size() || Load32( view.data() + 16 ) + nodeSize > view.size() )
+    {
+        return std::unexpected( "truncated binary ptree file " + fsPath.string() );
+    }
+
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+inline std::expected<void, std::string> BinaryPtree::Validate() const
+{
+    using namespace detail::binary;
+
+    const std::string_view view{ file.View() };
+    const char*            base{ view.data() };
+    const std::uint64_t    size{ view.size() };
+    const std::uint64_t    nodesEnd{ headerSize + std::uint64_t( Load32( base + 12 ) ) * nodeSize };
+
+    // Offset of a node in the node area
+    auto isNode = [&]( std::uint64_t offset )
+    {
+        return offset >= headerSize && offset + nodeSize <= nodesEnd && ( offset - headerSize ) % nodeSize == 0;
+    };
+
+    auto within = [&]( std::uint64_t offset, std::uint64_t length ) { return offset + length <= size; };
+
+    if ( nodesEnd > size || !isNode( Load32( base + 16 ) ) )
+    {
+        return std::unexpected( "invalid node table" );
+    }
+
+    for ( std::uint64_t node{ headerSize }; node < nodesEnd; node += nodeSize )
+    {
+        const char*         p{ base + node };
+        const std::uint64_t count{ Load32( p + 16 ) };
+        const std::uint64_t children{ Load32( p + 20 ) };
+        const std::uint64_t sorted{ Load32( p + 24 ) };
+        const std::string   where{ "node " + std::to_string( ( node - headerSize ) / nodeSize ) + ": " };
+
+        if ( !within( Load32( p ), Load32( p + 4 ) ) || !within( Load32( p + 8 ), Load32( p + 12 ) ) )
+        {
+            return std::unexpected( where + "string out of range" );
+        }
+
+        if ( !within( children, 4 * count ) || !within( sorted, 4 * count ) )
+        {
+            return std::unexpected( where + "child table out of range" );
+        }
+
+        for ( std::uint64_t i{ 0 }; i < count; ++i )
+        {
+            const std::uint64_t child{ Load32( base + children + 4 * i ) };
+
+            if ( !isNode( child ) || child <= node )
+            {
+                return std::unexpected( where + "invalid child offset" );
+            }
+
+            if ( Load32( base + sorted + 4 * i ) >= count )
+            {
+                return std::unexpected( where + "invalid sorted index" );
+            }
+        }
+    }
+    return {};
+}
+
+// -----------------------------------------------------------------------------
+// Writer definition
+// -----------------------------------------------------------------------------
+inline std::expected<std::string, std::string> SerializeBinary( const bpt::ptree& pt )
+{
+    using namespace detail::binary;
+
+    struct Item
+    {
+        const std::string* key;
+        const bpt::ptree*  tree;
+    };
+
+    // Nodes in pre-order
+    static const std::string noKey;
+    std::vector<Item>        items;
+
+    auto collect = [&]( auto& self, const std::string& key, const bpt::ptree& tree ) -> void
+    {
+        items.push_back( { &key, &tree } );
+
+        for ( const auto& kv : tree )
+        {
+            self( self, kv.first, kv.second );
+        }
+    };
+    collect( collect, noKey, pt );
+
+    // Layout: header, nodes, tables, string pool
+    const std::size_t nodesEnd{ headerSize + items.size() * nodeSize };
+    std::size_t       tablesSize{ 0 };
+
+    for ( const auto& item : items )
+    {
+        tablesSize += 2 * 4 * item.tree->size();
+    }
+
+    if ( nodesEnd + tablesSize > maxSize )
+    {
+        return std::unexpected( "binary ptree exceeds 4 GiB" );
+    }
+
+    std::string out( nodesEnd + tablesSize, '\0' );
+    std::string pool;
+
+    std::unordered_map<std::string_view, std::uint32_t> pooled;
+    const std::size_t                                   poolStart{ out.size() };
+
+    auto intern = [&]( const std::string& str ) -> std::uint32_t
+    {
+        if ( const auto it{ pooled.find( str ) }; it != pooled.end() )
+        {
+            return it->second;
+        }
+
+        const auto offset{ static_cast<std::uint32_t>( poolStart + pool.size() ) };
+        pool += str;
+        pooled.emplace( str, offset );
+        return offset;
+    };
+
+    std::size_t tablePos{ nodesEnd };
+
+    // Subtree size in nodes, for pre-order index of siblings
+    std::vector<std::size_t> subtreeSize( items.size(), 1 );
+
+    for ( std::size_t i{ items.size() }; i-- > 0; )
+    {
+        for ( std::size_t child{ i + 1 }, n{ 0 }; n < items[i].tree->size(); ++n )
+        {
+            subtreeSize[i] += subtreeSize[child];
+            child          += subtreeSize[child];
+        }
+    }
+
+    for ( std::size_t i{ 0 }; i < items.size(); ++i )
+    {
+        const Item&       item{ items[i] };
+        const std::size_t pos{ headerSize + i * nodeSize };
+        const std::size_t count{ item.tree->size() };
+
+        Store32( out, pos,      intern( *item.key ) );
+        Store32( out, pos + 4,  static_cast<std::uint32_t>( item.key->size() ) );
+        Store32( out, pos + 8,  intern( item.tree->data() ) );
+        Store32( out, pos + 12, static_cast<std::uint32_t>( item.tree->data().size() ) );
+        Store32( out, pos + 16, static_cast<std::uint32_t>( count ) );
+
+        if ( count == 0 )
+        {
+            continue;
+        }
+
+        const std::size_t childTable{ tablePos };
+        const std::size_t sortedTable{ tablePos + 4 * count };
+        tablePos += 8 * count;
+
+        Store32( out, pos + 20, static_cast<std::uint32_t>( childTable ) );
+        Store32( out, pos + 24, static_cast<std::uint32_t>( sortedTable ) );
+
+        // Children are consecutive subtrees following this node in pre-order
+        std::vector<std::size_t> children;
+        children.reserve( count );
+
+        for ( std::size_t child{ i + 1 }; children.size() < count; child += subtreeSize[child] )
+        {
+            Store32( out, childTable + 4 * children.size(),
+                     static_cast<std::uint32_t>( headerSize + child * nodeSize ) );
+            children.push_back( child );
+        }
+
+        std::vector<std::uint32_t> sorted( count );
+        for ( std::uint32_t n{ 0 }; n < count; ++n )
+        {
+            sorted[n] = n;
+        }
+
+        std::stable_sort( sorted.begin(), sorted.end(), [&]( std::uint32_t a, std::uint32_t b )
+        {
+            return *items[children[a]].key < *items[children[b]].key;
+        } );
+
+        for ( std::size_t n{ 0 }; n < count; ++n )
+        {
+            Store32( out, sortedTable + 4 * n, sorted[n] );
+        }
+    }
+
+    out += pool;
+
+    // Every stored offset, length and count is at most the file size
+    if ( out.size() > maxSize )
+    {
+        return std::unexpected( "binary ptree exceeds 4 GiB" );
+    }
+
+    std::copy( std::begin( magic ), std::end( magic ), out.begin() );
+    Store32( out, 8,  version );
+    Store32( out, 12, static_cast<std::uint32_t>( items.size() ) );
+    Store32( out, 16, headerSize );
+    Store32( out, 20, static_cast<std::uint32_t>( out.size() ) );
+
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+inline bool WriteBinary( const bpt::ptree& pt, const std::filesystem::path& fsPath )
+{
+    const auto out{ SerializeBinary( pt ) };
+
+    if ( !out )
+    {
+        return false;
+    }
+
+    std::ofstream stream( fsPath, std::ios::binary );
+
+    stream << *out;
+    return stream.good();
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeBinary_H
@@ -0,0 +1,370 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Read-only archive of config files, loaded with one open and one mmap.
+// Supported archives are tar (ustar, with GNU long names and pax paths) and
+// zip with stored, i.e. uncompressed, entries. Opening builds an index of
+// regular files; file contents are views into the mapping.
+//
+// Bundle paths are the paths of a virtual file system (see PtreeFileSystem.h),
+// e.g. archive member "./conf/a.info" is "/conf/a.info". Symbolic links are
+// not followed.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeBundle_H
+#define PtreeBundle_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <optional>
+#include <expected>
+#include <filesystem>
+#include <cstdint>
+#include <charconv>
+#include <algorithm>
+#include "PtreeMappedFile.h"
+#include "PtreeFileSystem.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+// Bundle
+// -----------------------------------------------------------------------------
+class Bundle final : public FileSystem
+{
+public:
+    /// Map archive and index its regular files
+    /// @return Bundle or error message
+    static std::expected<Bundle, std::string> Open( const std::filesystem::path& fsPath );
+
+    /// Content of file
+    /// @param path Bundle path, normalized if it is not
+    /// @return Nothing if there is no such file
+    std::optional<std::string_view> Find( const std::filesystem::path& path ) const
+    {
+        const auto it{ files.find( Normalize( path ).generic_string() ) };
+        return it != files.end() ? std::optional( it->second ) : std::nullopt;
+    }
+
+    /// Number of files
+    std::size_t Size() const { return files.size(); }
+
+    /// Archive the bundle was opened from
+    const std::filesystem::path& Archive() const { return archive; }
+
+    ResolvedPath Resolve( const std::filesystem::path& path ) const override
+    {
+        ResolvedPath resolved;
+        resolved.path   = Normalize( path );
+        resolved.exists = files.contains( resolved.path.generic_string() );
+        return resolved;
+    }
+
+    std::optional<std::string_view> Read( const std::filesystem::path& path, std::string& ) const override
+    {
+        return Find( path );
+    }
+
+    /// The archive, for every file
+    std::filesystem::path Dependency( const ResolvedPath& ) const override { return archive; }
+
+private:
+    std::optional<std::string> IndexTar();
+    std::optional<std::string> IndexZip();
+    void Add( std::string_view name, std::string_view content );
+
+    MappedFile                                        file;
+    std::filesystem::path                             archive;
+    std::unordered_map<std::string, std::string_view> files;  ///< Bundle path to content
+};
+
+// -----------------------------------------------------------------------------
+namespace detail::bundle
+{
+inline constexpr std::size_t blockSize{ 512 };
+
+/// Tar number field: octal text, or base-256 if the high bit of the first byte is set
+inline std::optional<std::uint64_t> TarNumber( std::string_view field )
+{
+    std::uint64_t value{ 0 };
+
+    if ( !field.empty() && ( static_cast<unsigned char>( field[0] ) & 0x80 ) )
+    {
+        value = static_cast<unsigned char>( field[0] ) & 0x7f;
+
+        for ( const char c : field.substr( 1 ) )
+        {
+            value = value << 8 | static_cast<unsigned char>( c );
+        }
+        return value;
+    }
+
+    std::size_t pos{ 0 };
+
+    while ( pos < field.size() && field[pos] == ' ' )
+    {
+        ++pos;
+    }
+
+    for ( ; pos < field.size() && field[pos] >= '0' && field[pos] <= '7'; ++pos )
+    {
+        value = value << 3 | static_cast<std::uint64_t>( field[pos] - '0' );
+    }
+
+    if ( pos < field.size() && field[pos] != ' ' && field[pos] != '\0' )
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+/// Tar text field, up to the first NUL
+inline std::string_view TarText( std::string_view field )
+{
+    return field.substr( 0, field.find( '\0' ) );
+}
+
+inline std::uint32_t Load16( const char* p )
+{
+    const auto* u{ reinterpret_cast<const unsigned char*>( p ) };
+    return std::uint32_t( u[0] ) | std::uint32_t( u[1] ) << 8;
+}
+
+inline std::uint32_t Load32( const char* p )
+{
+    const auto* u{ reinterpret_cast<const unsigned char*>( p ) };
+    return std::uint32_t( u[0] ) | std::uint32_t( u[1] ) << 8 | std::uint32_t( u[2] ) << 16 | std::uint32_t( u[3] ) << 24;
+}
+} // namespace detail::bundle
+
+// -----------------------------------------------------------------------------
+// Bundle definition
+// -----------------------------------------------------------------------------
+inline std::expected<Bundle, std::string> Bundle::Open( const std::filesystem::path& fsPath )
+{
+    Bundle result;
+
+    if ( !result.file.Open( fsPath ) )
+    {
+        return std::unexpected( "cannot map file " + fsPath.string() );
+    }
+
+    result.archive = fsPath;
+
+    const std::string_view view{ result.file.View() };
+    const auto             error{ view.starts_with( "PK" ) ? result.IndexZip() : result.IndexTar() };
+
+    if ( error )
+    {
+        return std::unexpected( *error + " in " + fsPath.string() );
+    }
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+inline void Bundle::Add( std::string_view name, std::string_view content )
+{
+    files.insert_or_assign( Normalize( std::filesystem::path( name ) ).generic_string(), content );
+}
+
+// -----------------------------------------------------------------------------
+inline std::optional<std::string> Bundle::IndexTar()
+{
+    using namespace detail::bundle;
+
+    const std::string_view view{ file.View() };
+    std::string            longName;  ///< From GNU 'L' or pax header, applies to the next entry
+    std::size_t            pos{ 0 };
+
+    while ( pos + blockSize <= view.size() )
+    {
+        const std::string_view header{ view.substr( pos, blockSize ) };
+
+        // Archive ends with zero blocks
+        if ( header[0] == '\0' )
+        {
+            return std::nullopt;
+        }
+
+        // Checksum of the header with the checksum field as spaces
+        std::uint64_t sum{ 8 * ' ' };
+
+        for ( std::size_t i{ 0 }; i < blockSize; ++i )
+        {
+            sum += i >= 148 && i < 156 ? 0 : static_cast<unsigned char>( header[i] );
+        }
+
+        const auto checksum{ TarNumber( header.substr( 148, 8 ) ) };
+        const auto size{ TarNumber( header.substr( 124, 12 ) ) };
+
+        if ( !checksum || *checksum != sum || !size )
+        {
+            return "invalid tar header at offset " + std::to_string( pos );
+        }
+
+        const std::size_t dataPos{ pos + blockSize };
+
+        if ( *size > view.size() - dataPos )
+        {
+            return "truncated tar entry at offset " + std::to_string( pos );
+        }
+
+        const std::string_view content{ view.substr( dataPos, *size ) };
+        const char             type{ header[156] };
+
+        pos = dataPos + ( *size + blockSize - 1 ) / blockSize * blockSize;
+
+        if ( type == 'L' )
+        {
+            longName = TarText( content );
+            continue;
+        }
+
+        if ( type == 'x' )
+        {
+            // Records "<length> <key>=<value>\n"
+            for ( std::string_view records{ content }; !records.empty(); )
+            {
+                const std::size_t space{ std::min( records.find( ' ' ), records.size() ) };
+                std::size_t       recordSize{ 0 };
+                const auto [digitsEnd, ec]{ std::from_chars( records.data(), records.data() + space, recordSize ) };
+
+                if ( ec != std::errc() || digitsEnd != records.data() + space ||
+                     recordSize <= space + 1 || recordSize > records.size() )
+                {
+                    return "invalid pax header at offset " + std::to_string( dataPos );
+                }
+
+                const std::string_view record{ records.substr( space + 1, recordSize - space - 2 ) };
+
+                if ( record.starts_with( "path=" ) )
+                {
+                    longName = record.substr( 5 );
+                }
+                records.remove_prefix( recordSize );
+            }
+            continue;
+        }
+
+        std::string name;
+
+        if ( !longName.empty() )
+        {
+            name = std::move( longName );
+            longName.clear();
+        }
+        else
+        {
+            const std::string_view prefix{ header.substr( 257, 6 ).starts_with( "ustar" ) ? TarText( header.substr( 345, 155 ) )
+                                                                                         : std::string_view() };
+            name = prefix.empty() ? std::string( TarText( header.substr( 0, 100 ) ) )
+                                  : std::string( prefix ) + '/' + std::string( TarText( header.substr( 0, 100 ) ) );
+        }
+
+        if ( type == '0' || type == '\0' || type == '7' )
+        {
+            Add( name, content );
+        }
+    }
+
+    // Not even a header in what is left, the end of archive blocks are optional
+    if ( pos < view.size() )
+    {
+        return std::string( "truncated tar archive" );
+    }
+    return std::nullopt;
+}
+
+// -----------------------------------------------------------------------------
+inline std::optional<std::string> Bundle::IndexZip()
+{
+    using namespace detail::bundle;
+
+    const std::string_view view{ file.View() };
+
+    // End of central directory record, followed by a comment of up to 64 KiB
+    constexpr std::size_t endSize{ 22 };
+    std::size_t           end{ std::string_view::npos };
+
+    for ( std::size_t pos{ view.size() >= endSize ? view.size() - endSize : std::string_view::npos };
+          pos != std::string_view::npos && view.size() - pos <= endSize + 0xffff; --pos )
+    {
+        // The signature may also occur in the comment, whose length must reach the end
+        if ( Load32( view.data() + pos ) == 0x06054b50 && pos + endSize + Load16( view.data() + pos + 20 ) == view.size() )
+        {
+            end = pos;
+            break;
+        }
+
+        if ( pos == 0 )
+        {
+            break;
+        }
+    }
+
+    if ( end == std::string_view::npos )
+    {
+        return std::string( "zip central directory not found" );
+    }
+
+    const std::size_t count{ Load16( view.data() + end + 10 ) };
+    std::size_t       pos{ Load32( view.data() + end + 16 ) };
+
+    for ( std::size_t i{ 0 }; i < count; ++i )
+    {
+        if ( pos + 46 > end || Load32( view.data() + pos ) != 0x02014b50 )
+        {
+            return "invalid zip central directory entry " + std::to_string( i );
+        }
+
+        const char*       entry{ view.data() + pos };
+        const std::size_t nameSize{ Load16( entry + 28 ) };
+        const std::size_t local{ Load32( entry + 42 ) };
+        const std::size_t size{ Load32( entry + 20 ) };
+
+        if ( pos + 46 + nameSize > end )
+        {
+            return "invalid zip central directory entry " + std::to_string( i );
+        }
+
+        const std::string_view name{ entry + 46, nameSize };
+
+        pos += 46 + nameSize + Load16( entry + 30 ) + Load16( entry + 32 );
+
+        // Directories
+        if ( name.ends_with( '/' ) )
+        {
+            continue;
+        }
+
+        if ( Load16( entry + 10 ) != 0 )
+        {
+            return "compressed zip entry " + std::string( name );
+        }
+
+        if ( local + 30 > view.size() || Load32( view.data() + local ) != 0x04034b50 )
+        {
+            return "invalid zip local header of " + std::string( name );
+        }
+
+        const std::size_t dataPos{ local + 30 + Load16( view.data() + local + 26 ) + Load16( view.data() + local + 28 ) };
+
+        if ( dataPos > view.size() || size > view.size() - dataPos )
+        {
+            return "truncated zip entry " + std::string( name );
+        }
+
+        Add( name, view.substr( dataPos, size ) );
+    }
+    return std::nullopt;
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeBundle_H
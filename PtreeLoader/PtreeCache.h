@@ -0,0 +1,101 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Cache shared between PtreeLoader instances, e.g. when many root files that
+// include the same fragments are loaded in one process.
+// Holds resolved include paths and parsed files, thread-safe.
+// Entries are never invalidated, the cache must not outlive the file contents
+// it was built from.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeCache_H
+#define PtreeCache_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <filesystem>
+#include <cstdint>
+#include <boost/property_tree/ptree.hpp>
+#include "PtreeParsers.h"
+#include "PtreeFileSystem.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+namespace bpt = boost::property_tree;
+
+// -----------------------------------------------------------------------------
+/// Result of parsing one file
+struct Fragment
+{
+    bpt::ptree                tree;        ///< Parsed content, well-formed prefix if there are errors
+    std::vector<ParseError>   errors;
+    std::uint64_t             size{ 0 };
+    std::vector<ResolvedPath> directives;  ///< Files of INFO #include directives, for dependencies
+};
+
+// -----------------------------------------------------------------------------
+// LoadCache
+// -----------------------------------------------------------------------------
+class LoadCache
+{
+public:
+    using FragmentPtr = std::shared_ptr<const Fragment>;
+
+    LoadCache()                               = default;
+    LoadCache( const LoadCache& )             = delete;
+    LoadCache& operator=( const LoadCache& )  = delete;
+
+    /// Find resolved include path
+    /// @param key Joined (not canonical) include path
+    std::optional<ResolvedPath> FindPath( const std::string& key ) const
+    {
+        std::shared_lock lock( pathMutex );
+
+        const auto it{ paths.find( key ) };
+        return it != paths.end() ? std::optional( it->second ) : std::nullopt;
+    }
+
+    /// Store resolved include path
+    void StorePath( const std::string& key, const ResolvedPath& resolved )
+    {
+        std::unique_lock lock( pathMutex );
+        paths.emplace( key, resolved );
+    }
+
+    /// Find parsed file
+    /// @param key Format tag and canonical path
+    FragmentPtr FindFragment( const std::string& key ) const
+    {
+        std::shared_lock lock( fragmentMutex );
+
+        const auto it{ fragments.find( key ) };
+        return it != fragments.end() ? it->second : nullptr;
+    }
+
+    /// Store parsed file
+    /// @return Stored fragment, the earlier one if another thread was faster
+    FragmentPtr StoreFragment( const std::string& key, FragmentPtr fragment )
+    {
+        std::unique_lock lock( fragmentMutex );
+        return fragments.emplace( key, std::move( fragment ) ).first->second;
+    }
+
+private:
+    mutable std::shared_mutex                     pathMutex;
+    std::unordered_map<std::string, ResolvedPath> paths;
+    mutable std::shared_mutex                     fragmentMutex;
+    std::unordered_map<std::string, FragmentPtr>  fragments;
+};
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeCache_H
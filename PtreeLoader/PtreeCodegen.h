@@ -0,0 +1,415 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Generator of C++ structs from a config schema. PtreeCodegen runs it at
+// build time (see Codegen/CMakeLists.txt for the ptree_codegen() function).
+// Services read typed fields of the structs instead of looking up string
+// paths in a ptree.
+//
+// Schema, in INFO format, one entry per struct:
+//   <Type> [<config path>]       struct populated from the node at path,
+//   {                            the root if none
+//       <key> <type>             field, type is one of bool, int, unsigned,
+//                                int64, uint64, float, double, string
+//       <key> [<Type>]           nested struct, type name <key>Node if none
+//       {
+//           ...
+//       }
+//   }
+// Keys and type names are C++ identifiers other than keywords, unique within
+// their struct, and top-level type names are unique. Every field must be
+// present in the config the header is generated from and convert to its type;
+// its value becomes the default member initializer.
+//
+// Each struct gets a Populate() overload that overwrites fields with values of
+// a ptree loaded at run time. It is straight-line code: one helper call per
+// field, missing or invalid values keep the current value.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeCodegen_H
+#define PtreeCodegen_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <optional>
+#include <expected>
+#include <set>
+#include <fstream>
+#include <filesystem>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <boost/property_tree/ptree.hpp>
+#include "PtreeTranslator.h"
+#include "PtreeEmbedded.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+namespace bpt = boost::property_tree;
+
+// -----------------------------------------------------------------------------
+// Populate helpers, called by generated code
+// -----------------------------------------------------------------------------
+/// Child with key, an empty tree if there is none
+/// @param path Dotted path of the child
+inline const bpt::ptree& ChildOrEmpty( const bpt::ptree& pt, const char* path )
+{
+    static const bpt::ptree empty;
+    return pt.get_child( path, empty );
+}
+
+/// Assign data of child with key to field, if there is a child and its data converts
+template<typename V>
+void PopulateField( V& field, const bpt::ptree& pt, const char* key )
+{
+    const auto it{ pt.find( key ) };
+
+    if ( it == pt.not_found() )
+    {
+        return;
+    }
+
+    if constexpr ( std::is_same_v<V, std::string> )
+    {
+        field = it->second.data();
+    }
+    else if ( const auto value{ FromChars<V>( it->second.data() ) } )
+    {
+        field = *value;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Generator
+// -----------------------------------------------------------------------------
+/// C++ header with structs and Populate() overloads, see file comment
+/// @param schema Schema tree
+/// @param pt Config tree providing default values
+/// @param ns Namespace of the structs, may be nested ("a::b")
+/// @param source Description of where schema and config came from, for the header comment
+/// @return Header or error messages, one per line
+inline std::expected<std::string, std::string> GenerateStructs( const bpt::ptree& schema, const bpt::ptree& pt,
+                                                                std::string_view ns, std::string_view source );
+
+/// Write header generated by GenerateStructs() to file
+/// @return Error messages if the header could not be generated or written
+inline std::optional<std::string> WriteStructs( const bpt::ptree& schema, const bpt::ptree& pt,
+                                                const std::filesystem::path& fsPath, std::string_view ns,
+                                                std::string_view source )
+{
+    const auto header{ GenerateStructs( schema, pt, ns, source ) };
+
+    if ( !header )
+    {
+        return header.error();
+    }
+
+    std::ofstream stream( fsPath, std::ios::binary );
+    stream << *header;
+
+    if ( !stream.good() )
+    {
+        return "cannot write " + fsPath.string() + '\n';
+    }
+    return std::nullopt;
+}
+
+// -----------------------------------------------------------------------------
+namespace detail::codegen
+{
+struct FieldType
+{
+    std::string_view name;
+    std::string_view cpp;
+};
+
+inline constexpr FieldType fieldTypes[]{
+    { "bool", "bool" },           { "int", "int" },     { "unsigned", "unsigned" }, { "int64", "std::int64_t" },
+    { "uint64", "std::uint64_t" }, { "float", "float" }, { "double", "double" },     { "string", "std::string" } };
+
+/// Keywords and alternative tokens, and namespaces the generated code refers to
+inline constexpr std::string_view reservedNames[]{
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+    "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept", "const", "consteval", "constexpr",
+    "constinit", "const_cast", "continue", "co_await", "co_return", "co_yield", "decltype", "default", "delete",
+    "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for",
+    "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+    "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+    "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+    "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename",
+    "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq",
+    "std", "boost", "ptree_loader" };
+
+inline bool IsIdentifier( std::string_view str )
+{
+    const auto isAlpha{ []( char c ) { return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || c == '_'; } };
+
+    return !str.empty() && isAlpha( str[0] ) &&
+           std::ranges::all_of( str, [&]( char c ) { return isAlpha( c ) || ( c >= '0' && c <= '9' ); } );
+}
+
+/// Why name cannot be declared in generated code
+/// @param names Names already declared in the same scope, name is added
+/// @return Nothing if name can be declared
+inline std::optional<std::string> NameError( const std::string& name, std::set<std::string>& names )
+{
+    if ( !IsIdentifier( name ) )
+    {
+        return "is not a C++ identifier";
+    }
+    if ( std::ranges::find( reservedNames, name ) != std::end( reservedNames ) )
+    {
+        return "is a reserved C++ name";
+    }
+    if ( !names.insert( name ).second )
+    {
+        return "is declared twice";
+    }
+    return std::nullopt;
+}
+
+/// Why ns cannot be the namespace of generated code
+/// @param ns Namespace, may be nested ("a::b")
+/// @return Nothing if every component can be declared
+inline std::optional<std::string> NamespaceError( std::string_view ns )
+{
+    for ( std::size_t begin{ 0 }; begin <= ns.size(); )
+    {
+        const std::size_t     end{ std::min( ns.find( "::", begin ), ns.size() ) };
+        std::set<std::string> names;
+
+        if ( const auto error{ NameError( std::string( ns.substr( begin, end - begin ) ), names ) } )
+        {
+            return error;
+        }
+        begin = end + 2;
+    }
+    return std::nullopt;
+}
+
+/// Brace initializer of a V literal
+/// @return Nothing if data is not a V
+template<FastConvertible V>
+std::optional<std::string> Literal( std::string_view data, std::string_view cpp )
+{
+    const auto value{ FromChars<V>( data ) };
+
+    if ( !value )
+    {
+        return std::nullopt;
+    }
+
+    const std::string limits{ "std::numeric_limits<" + std::string( cpp ) + ">::" };
+
+    if constexpr ( std::is_floating_point_v<V> )
+    {
+        if ( std::isnan( *value ) )
+        {
+            return "{ " + limits + "quiet_NaN() }";
+        }
+        if ( std::isinf( *value ) )
+        {
+            return "{ " + std::string( *value < 0 ? "-" : "" ) + limits + "infinity() }";
+        }
+    }
+    else if constexpr ( std::is_signed_v<V> )
+    {
+        // Negated literal of the minimum does not fit its type
+        if ( *value == std::numeric_limits<V>::min() )
+        {
+            return "{ " + limits + "min() }";
+        }
+    }
+    else if constexpr ( !std::is_same_v<V, bool> )
+    {
+        return "{ " + ToChars( *value ) + "u }";
+    }
+    return "{ " + ToChars( *value ) + " }";
+}
+
+/// Default member initializer of a field of type from config data
+inline std::optional<std::string> Initializer( const FieldType& type, std::string_view data )
+{
+    const std::string_view name{ type.name };
+
+    if ( name == "string" )
+    {
+        return EmbeddedString( data );
+    }
+    if ( name == "bool" )
+    {
+        return Literal<bool>( data, type.cpp );
+    }
+    if ( name == "int" )
+    {
+        return Literal<int>( data, type.cpp );
+    }
+    if ( name == "unsigned" )
+    {
+        return Literal<unsigned>( data, type.cpp );
+    }
+    if ( name == "int64" )
+    {
+        return Literal<std::int64_t>( data, type.cpp );
+    }
+    if ( name == "uint64" )
+    {
+        return Literal<std::uint64_t>( data, type.cpp );
+    }
+    if ( name == "float" )
+    {
+        return Literal<float>( data, type.cpp );
+    }
+    return Literal<double>( data, type.cpp );
+}
+
+/// Generation state
+struct Output
+{
+    std::string populate;  ///< Populate() overloads, nested structs first
+    std::string errors;
+};
+
+/// Definition of one struct, appends its Populate() overload and those of nested structs
+/// @param configPath Dotted path of the struct node in the tree Populate() takes, empty for nested structs
+/// @param path Dotted path of the struct node in the config, for messages
+inline std::string Struct( const bpt::ptree& schema, const bpt::ptree& pt, const std::string& type,
+                           const std::string& qualified, const std::string& configPath, const std::string& path,
+                           const std::string& indent, Output& out )
+{
+    static const bpt::ptree empty;
+
+    std::string           body{ indent + "struct " + type + '\n' + indent + "{\n" };
+    std::set<std::string> names{ type };  // Members must not repeat each other or the struct name
+    std::string populate{ "inline void Populate( " + qualified + "& value, const boost::property_tree::ptree& " };
+
+    populate += configPath.empty() ? "pt )\n{\n"
+                                   : "root )\n{\n    const boost::property_tree::ptree& pt{ ptree_loader::ChildOrEmpty( root, \"" +
+                                         configPath + "\" ) };\n\n";
+
+    for ( const auto& [key, field] : schema )
+    {
+        const std::string fieldPath{ path.empty() ? key : path + '.' + key };
+        const auto        it{ pt.find( key ) };
+        const bpt::ptree* node{ it != pt.not_found() ? &it->second : nullptr };
+
+        if ( const auto error{ NameError( key, names ) } )
+        {
+            out.errors += fieldPath + ": key " + *error + '\n';
+            continue;
+        }
+
+        // Nested struct
+        if ( !field.empty() )
+        {
+            const std::string nestedType{ field.data().empty() ? key + "Node" : field.data() };
+
+            if ( const auto error{ NameError( nestedType, names ) } )
+            {
+                out.errors += fieldPath + ": type " + nestedType + ' ' + *error + '\n';
+                continue;
+            }
+
+            body += Struct( field, node ? *node : empty, nestedType, qualified + "::" + nestedType, {}, fieldPath,
+                            indent + "    ", out );
+            body += indent + "    " + nestedType + ' ' + key + ";\n";
+            populate += "    Populate( value." + key + ", ptree_loader::ChildOrEmpty( pt, \"" + key + "\" ) );\n";
+            continue;
+        }
+
+        const auto fieldType{ std::ranges::find( fieldTypes, field.data(), &FieldType::name ) };
+
+        if ( fieldType == std::end( fieldTypes ) )
+        {
+            out.errors += fieldPath + ": unknown type " + field.data() + '\n';
+            continue;
+        }
+
+        if ( !node )
+        {
+            out.errors += fieldPath + ": missing in config\n";
+            continue;
+        }
+
+        const auto initializer{ Initializer( *fieldType, node->data() ) };
+
+        if ( !initializer )
+        {
+            out.errors += fieldPath + ": not a " + field.data() + ": " + node->data() + '\n';
+            continue;
+        }
+
+        body += indent + "    " + std::string( fieldType->cpp ) + ' ' + key + *initializer + ";\n";
+        populate += "    ptree_loader::PopulateField( value." + key + ", pt, \"" + key + "\" );\n";
+    }
+
+    out.populate += ( out.populate.empty() ? "" : "\n" ) + populate + "}\n";
+    return body + indent + "};\n";
+}
+} // namespace detail::codegen
+
+// -----------------------------------------------------------------------------
+// Generator definition
+// -----------------------------------------------------------------------------
+inline std::expected<std::string, std::string> GenerateStructs( const bpt::ptree& schema, const bpt::ptree& pt,
+                                                                std::string_view ns, std::string_view source )
+{
+    using namespace detail::codegen;
+
+    Output                out;
+    std::string           structs;
+    std::set<std::string> types;
+
+    if ( const auto error{ NamespaceError( ns ) } )
+    {
+        return std::unexpected( "namespace \"" + std::string( ns ) + "\" " + *error + '\n' );
+    }
+
+    for ( const auto& [type, entry] : schema )
+    {
+        if ( const auto error{ NameError( type, types ) } )
+        {
+            out.errors += type + ": type " + *error + '\n';
+            continue;
+        }
+
+        const std::string& configPath{ entry.data() };
+        const auto         node{ pt.get_child_optional( configPath ) };
+
+        if ( !node )
+        {
+            out.errors += configPath + ": missing in config\n";
+            continue;
+        }
+
+        structs += Struct( entry, *node, type, type, configPath, configPath, {}, out ) + '\n';
+    }
+
+    if ( !out.errors.empty() )
+    {
+        return std::unexpected( out.errors );
+    }
+
+    std::string header;
+
+    header += "// Generated from " + std::string( source ) + ", do not edit\n";
+    header += "#pragma once\n\n";
+    header += "#include <string>\n";
+    header += "#include <limits>\n";
+    header += "#include <cstdint>\n";
+    header += "#include \"PtreeCodegen.h\"\n\n";
+    header += "namespace " + std::string( ns ) + "\n{\n";
+    header += structs;
+    header += out.populate;
+    header += "} // namespace " + std::string( ns ) + "\n";
+    return header;
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeCodegen_H
@@ -0,0 +1,894 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Compact read-only tree produced by PtreeLoader::LoadCompact().
+// Keys and values are 16-byte small strings: up to 15 characters are stored
+// inline, longer strings point into storage owned by the tree, which can be
+// the retained source buffer the tree was parsed from. Nodes live in
+// one vector and the children of a node are a contiguous block of it, so a
+// node costs 40 bytes and no allocation of its own. Homogeneous numeric arrays
+// can be stored packed, as one int64 or double per element instead of a node,
+// if every element text is exactly what the number converts back to.
+// An optional key index gives O(log n) lookup by key and O(1) access to the
+// nth child with a given key.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeCompact_H
+#define PtreeCompact_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <variant>
+#include <utility>
+#include <span>
+#include <boost/property_tree/ptree.hpp>
+#include "PtreeTranslator.h"
+#include "PtreeUtils.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+namespace bpt = boost::property_tree;
+
+// -----------------------------------------------------------------------------
+// CompactString : 16-byte string with inline storage for up to 15 characters
+// -----------------------------------------------------------------------------
+class CompactString
+{
+public:
+    static constexpr std::size_t inlineCapacity{ 15 };
+
+    /// Empty string
+    CompactString() noexcept { bytes[inlineCapacity] = inlineCapacity; }
+
+    /// Inline copy of a string of at most inlineCapacity characters
+    static CompactString Inline( std::string_view str ) noexcept
+    {
+        CompactString s;
+        std::copy( str.begin(), str.end(), s.bytes );
+        s.bytes[inlineCapacity] = static_cast<char>( inlineCapacity - str.size() );
+        return s;
+    }
+
+    /// Reference to a string stored elsewhere
+    static CompactString External( const char* data, std::size_t size ) noexcept
+    {
+        const auto    size32{ static_cast<std::uint32_t>( size ) };
+        CompactString s;
+        std::memcpy( s.bytes, &data, sizeof( data ) );
+        std::memcpy( s.bytes + 8, &size32, sizeof( size32 ) );
+        s.bytes[inlineCapacity] = externalTag;
+        return s;
+    }
+
+    bool IsInline() const noexcept { return bytes[inlineCapacity] != externalTag; }
+
+    std::string_view View() const noexcept
+    {
+        if ( IsInline() )
+        {
+            return { bytes, inlineCapacity - static_cast<std::size_t>( bytes[inlineCapacity] ) };
+        }
+
+        const char*   data;
+        std::uint32_t size;
+        std::memcpy( &data, bytes, sizeof( data ) );
+        std::memcpy( &size, bytes + 8, sizeof( size ) );
+        return { data, size };
+    }
+
+private:
+    static constexpr char externalTag{ static_cast<char>( 0xff ) };
+
+    /// Inline: characters, last byte holds inlineCapacity - size, so a full
+    /// string is NUL terminated. External: pointer, uint32 size, last byte tag.
+    char bytes[16];
+};
+
+static_assert( sizeof( CompactString ) == 16 );
+
+// -----------------------------------------------------------------------------
+// StringArena : chunked storage for strings that don't fit inline
+// -----------------------------------------------------------------------------
+class StringArena
+{
+public:
+    StringArena() = default;
+    StringArena( StringArena&& other ) noexcept   { Swap( other ); }
+    StringArena& operator=( StringArena&& other ) noexcept { StringArena( std::move( other ) ).Swap( *this ); return *this; }
+
+    /// Copy string into the arena
+    std::string_view Store( std::string_view str )
+    {
+        if ( str.size() > available )
+        {
+            const std::size_t size{ std::max( chunkSize, str.size() ) };
+            chunks.push_back( std::make_unique<char[]>( size ) );
+            cursor    = chunks.back().get();
+            available = size;
+        }
+
+        char* data{ cursor };
+        std::memcpy( data, str.data(), str.size() );
+        cursor    += str.size();
+        available -= str.size();
+        return { data, str.size() };
+    }
+
+private:
+    static constexpr std::size_t chunkSize{ 64 * 1024 };
+
+    void Swap( StringArena& other ) noexcept
+    {
+        std::swap( chunks, other.chunks );
+        std::swap( cursor, other.cursor );
+        std::swap( available, other.available );
+    }
+
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char*                                cursor{ nullptr };
+    std::size_t                          available{ 0 };
+};
+
+class CompactTree;
+
+// -----------------------------------------------------------------------------
+// CompactNode : view of one node of a CompactTree
+// -----------------------------------------------------------------------------
+class CompactNode
+{
+public:
+    class Iterator;
+    class KeyRange;
+
+    CompactNode( const CompactTree& tree, std::uint32_t index ) : tree( &tree ), index( index ) {}
+
+    std::string_view Key() const;
+    std::string_view Data() const;
+    std::size_t      Size() const;
+    bool             Empty() const { return Size() == 0; }
+
+    /// Child in document order, O(1)
+    CompactNode Child( std::size_t i ) const;
+
+    /// Child in document order, nothing if out of range
+    std::optional<CompactNode> At( std::size_t i ) const;
+
+    /// First child with key, binary search if the tree has a key index
+    std::optional<CompactNode> Find( std::string_view key ) const;
+
+    /// All children with key in document order, with O(1) positional access
+    /// if the tree has a key index
+    KeyRange EqualRange( std::string_view key ) const;
+
+    /// Descendant by path
+    /// @param path Keys separated by separator, empty path is this node
+    std::optional<CompactNode> FindPath( std::string_view path, char separator = '.' ) const;
+
+    /// Packed numeric elements, empty unless the node is packed with that type
+    /// Packed elements are not child nodes, Size() of a packed node is 0.
+    std::span<const std::int64_t> Integers() const;
+    std::span<const double>       Reals() const;
+
+    /// Number of packed elements, 0 unless the node is packed
+    std::size_t Elements() const;
+
+    /// Text of the packed element, as in the source, nothing if out of range
+    std::optional<std::string> Element( std::size_t i ) const;
+
+    /// Data converted to V, from the pre-converted scalar if the tree has them
+    template<FastConvertible V>
+    std::optional<V> GetValue() const;
+
+    /// Copy subtree into a ptree
+    bpt::ptree ToPtree() const;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+private:
+    friend class CompactTree;
+    friend class CompactBuilder;
+
+    const CompactTree* tree;
+    std::uint32_t      index;
+};
+
+// -----------------------------------------------------------------------------
+class CompactNode::KeyRange
+{
+public:
+    std::size_t Size() const  { return Offsets().size(); }
+    bool        Empty() const { return Offsets().empty(); }
+
+    /// The nth child with the key
+    CompactNode operator[]( std::size_t n ) const { return parent.Child( Offsets()[n] ); }
+
+private:
+    friend class CompactNode;
+
+    KeyRange( const CompactNode& parent ) : parent( parent ) {}
+
+    std::span<const std::uint32_t> Offsets() const { return owned.empty() ? offsets : owned; }
+
+    CompactNode                     parent;
+    std::span<const std::uint32_t>  offsets;  ///< Child positions in the key index
+    std::vector<std::uint32_t>      owned;    ///< Positions found by scanning, without key index
+};
+
+// -----------------------------------------------------------------------------
+class CompactNode::Iterator
+{
+public:
+    Iterator( const CompactNode& parent, std::size_t i ) : parent( parent ), i( i ) {}
+
+    CompactNode operator*() const                        { return parent.Child( i ); }
+    Iterator&   operator++()                             { ++i; return *this; }
+    bool        operator==( const Iterator& other ) const { return i == other.i; }
+
+private:
+    CompactNode parent;
+    std::size_t i;
+};
+
+// -----------------------------------------------------------------------------
+// CompactTree
+// -----------------------------------------------------------------------------
+class CompactTree
+{
+public:
+    /// Pre-converted node data, monostate if the data is not a scalar
+    using Scalar = std::variant<std::monostate, bool, std::int64_t, double>;
+
+    /// Storage of a node's children
+    enum class Packing : std::uint8_t
+    {
+        none,      ///< Child nodes
+        integers,  ///< Packed int64 elements, no child nodes
+        reals      ///< Packed double elements, no child nodes
+    };
+
+    CompactTree() { nodes.push_back( {} ); }
+    CompactTree( const CompactTree& )             = delete;
+    CompactTree& operator=( const CompactTree& )  = delete;
+    CompactTree( CompactTree&& )                  = default;
+    CompactTree& operator=( CompactTree&& )       = default;
+
+    CompactNode Root() const { return { *this, 0 }; }
+
+    /// Number of nodes including the root
+    std::size_t NodeCount() const { return nodes.size(); }
+
+    /// Descendant of the root by dotted path
+    std::optional<CompactNode> Find( std::string_view path, char separator = '.' ) const
+    {
+        return Root().FindPath( path, separator );
+    }
+
+    /// Value of the descendant by dotted path
+    template<FastConvertible V>
+    std::optional<V> Get( std::string_view path, char separator = '.' ) const
+    {
+        const auto node{ Find( path, separator ) };
+        return node ? node->GetValue<V>() : std::nullopt;
+    }
+
+    /// Detect and pre-convert the data of every node to bool, int64 or double
+    /// Text is kept, typed reads of converted nodes become a tag check and a load.
+    /// One sequential pass over the final nodes: the builder writes nodes from
+    /// several paths (blocks, copies of included fragments, root) and packed
+    /// arrays never reach it, and the pass also serves trees built without
+    /// SetTypedScalars(). A scalar takes 16 bytes, the 8-byte value plus its tag.
+    void ConvertScalars();
+
+    /// Whether ConvertScalars() was called
+    bool HasScalars() const { return !scalars.empty(); }
+
+    /// Build index of the children of every node by key, for Find() and EqualRange()
+    void BuildKeyIndex();
+
+    /// Whether BuildKeyIndex() was called
+    bool HasKeyIndex() const { return !keyOrder.empty(); }
+
+    /// Remove all nodes and storage
+    void Clear() { *this = CompactTree(); }
+
+private:
+    friend class CompactNode;
+    friend class CompactBuilder;
+
+    struct Record
+    {
+        static constexpr int           packingShift{ 30 };
+        static constexpr std::uint32_t lengthMask{ ( 1u << packingShift ) - 1 };
+
+        CompactString key;
+        CompactString data;
+        std::uint32_t first{ 0 };  ///< Index of the first child or packed element
+        std::uint32_t count{ 0 };  ///< Number of children or packed elements, Packing in the top bits
+
+        Packing       Packed() const   { return static_cast<Packing>( count >> packingShift ); }
+        std::uint32_t Children() const { return Packed() == Packing::none ? count : 0; }
+        std::uint32_t Length() const   { return count & lengthMask; }
+    };
+
+    /// String stored inline or in the arena
+    CompactString Store( std::string_view str )
+    {
+        if ( str.size() <= CompactString::inlineCapacity )
+        {
+            return CompactString::Inline( str );
+        }
+
+        const std::string_view stored{ arena.Store( str ) };
+        return CompactString::External( stored.data(), stored.size() );
+    }
+
+    std::vector<Record>                      nodes;         ///< Root first, children blocks contiguous
+    std::vector<Scalar>                      scalars;       ///< Parallel to nodes if converted
+    std::vector<std::uint32_t>               keyOrder;      ///< Parallel to nodes if indexed: child
+                                                            ///< positions of each block sorted by key
+    std::vector<std::int64_t>                integers;      ///< Packed integer arrays
+    std::vector<double>                      reals;         ///< Packed real arrays
+    std::vector<CompactString>               integerTexts;  ///< Parallel to integers: text in the source
+    std::vector<CompactString>               realTexts;     ///< Parallel to reals: text in the source
+    StringArena                              arena;
+    std::vector<std::shared_ptr<const void>> retained;      ///< Storage referenced by external strings
+};
+
+// -----------------------------------------------------------------------------
+// CompactBuilder : parser handler that builds a CompactTree
+// -----------------------------------------------------------------------------
+// Children of a node are collected per nesting level and written to the tree
+// as one block when the node is closed, which keeps every block contiguous.
+class CompactBuilder
+{
+public:
+    explicit CompactBuilder( CompactTree& tree ) : tree( tree ), levels( 1 ) {}
+    CompactBuilder( const CompactBuilder& )             = delete;
+    CompactBuilder& operator=( const CompactBuilder& )  = delete;
+
+    /// Strings that lie inside source are referenced rather than copied
+    /// The source buffer must be retained with Retain().
+    void SetSource( std::string_view buffer ) { source = buffer; }
+
+    /// Store arrays of at least minSize numbers with empty keys packed, 0 disables
+    void SetPackArrays( std::size_t minSize ) { packMinSize = minSize; }
+
+    void Key( std::string_view key )
+    {
+        levels[depth].push_back( { Store( key ), {}, 0, 0 } );
+        last = levels[depth].size() - 1;
+    }
+
+    void Value( std::string_view value )
+    {
+        Current().data = Store( value );
+    }
+
+    void Enter()
+    {
+        if ( last == none && depth == 0 )
+        {
+            return; // Descending into the root itself
+        }
+
+        entered.push_back( last == none ? levels[depth].size() - 1 : last );
+        if ( ++depth == levels.size() )
+        {
+            levels.emplace_back();
+        }
+        last = none;
+    }
+
+    void Leave()
+    {
+        if ( depth == 0 )
+        {
+            return;
+        }
+
+        auto& children{ levels[depth] };
+        --depth;
+        Close( levels[depth][entered.back()], children );
+        children.clear();
+        entered.pop_back();
+        last = none;
+    }
+
+    /// Children of an INFO #include follow, the last child before them stays last
+    void BeginInclude() { included.push_back( { depth, last } ); }
+
+    void EndInclude()
+    {
+        if ( included.back().first == depth )
+        {
+            last = included.back().second;
+        }
+        included.pop_back();
+    }
+
+    /// Append copy of a node with its subtree as child of the current node
+    /// Strings are shared, the source tree storage must be retained with Retain().
+    void AppendCopy( const CompactNode& node )
+    {
+        const CompactTree::Record& source{ node.tree->nodes[node.index] };
+
+        levels[depth].push_back( source );
+        last = levels[depth].size() - 1;
+        CopyContent( *node.tree, source, levels[depth].back() );
+    }
+
+    /// Keep storage referenced by copied strings alive as long as the tree
+    void Retain( std::shared_ptr<const void> storage )
+    {
+        tree.retained.push_back( std::move( storage ) );
+    }
+
+    /// Move the arena out of the tree, for a tree that is only a source of
+    /// AppendCopy(), so copies can retain the strings without the tree
+    StringArena TakeArena() { return std::move( tree.arena ); }
+
+    /// Write the children of the root, call once after the last event
+    /// The root is never packed: PtreeLoader merges files child by child.
+    void Finish()
+    {
+        while ( depth > 0 )
+        {
+            Leave();
+        }
+        Close( tree.nodes[0], levels[0], false );
+        levels[0].clear();
+    }
+
+private:
+    static constexpr std::size_t none{ static_cast<std::size_t>( -1 ) };
+
+    /// Short strings inline, views into the source by reference, others copied
+    CompactString Store( std::string_view str )
+    {
+        const std::less<const char*> less;
+
+        if ( str.size() > CompactString::inlineCapacity && !less( str.data(), source.data() ) &&
+             !less( source.data() + source.size(), str.data() + str.size() ) )
+        {
+            return CompactString::External( str.data(), str.size() );
+        }
+        return tree.Store( str );
+    }
+
+    /// Node that Value() applies to
+    CompactTree::Record& Current()
+    {
+        if ( last != none )
+        {
+            return levels[depth][last];
+        }
+        return depth == 0 ? tree.nodes[0] : levels[depth - 1][entered.back()];
+    }
+
+    /// Write children of parent to the tree, packed if possible
+    void Close( CompactTree::Record& parent, const std::vector<CompactTree::Record>& children, bool packable = true )
+    {
+        if ( packable && packMinSize && children.size() >= packMinSize && Pack( parent, children ) )
+        {
+            return;
+        }
+
+        parent.first = static_cast<std::uint32_t>( tree.nodes.size() );
+        parent.count = static_cast<std::uint32_t>( children.size() );
+        tree.nodes.insert( tree.nodes.end(), children.begin(), children.end() );
+    }
+
+    /// Store children as packed numbers if all are leaves with empty keys and
+    /// numeric data, as integers if all are integers, as reals otherwise
+    /// Each element is converted once, its text is kept for Element().
+    bool Pack( CompactTree::Record& parent, const std::vector<CompactTree::Record>& children )
+    {
+        bool isReal{ false };
+
+        packedIntegers.clear();
+        packedReals.clear();
+
+        for ( const auto& child : children )
+        {
+            if ( !child.key.View().empty() || child.count )
+            {
+                return false;
+            }
+
+            const std::string_view data{ child.data.View() };
+
+            if ( !isReal )
+            {
+                if ( const auto value{ FromChars<std::int64_t>( data ) } )
+                {
+                    packedIntegers.push_back( *value );
+                    continue;
+                }
+
+                // Integers so far become reals, rounded as if read as reals
+                isReal = true;
+                packedReals.assign( packedIntegers.begin(), packedIntegers.end() );
+            }
+
+            const auto value{ FromChars<double>( data ) };
+
+            if ( !value )
+            {
+                return false;
+            }
+            packedReals.push_back( *value );
+        }
+
+        const auto packing{ isReal ? CompactTree::Packing::reals : CompactTree::Packing::integers };
+        auto&      texts{ isReal ? tree.realTexts : tree.integerTexts };
+
+        parent.first = static_cast<std::uint32_t>( texts.size() );
+        parent.count = static_cast<std::uint32_t>( children.size() ) |
+                       static_cast<std::uint32_t>( packing ) << CompactTree::Record::packingShift;
+
+        if ( isReal )
+        {
+            tree.reals.insert( tree.reals.end(), packedReals.begin(), packedReals.end() );
+        }
+        else
+        {
+            tree.integers.insert( tree.integers.end(), packedIntegers.begin(), packedIntegers.end() );
+        }
+
+        for ( const auto& child : children )
+        {
+            texts.push_back( child.data );
+        }
+        return true;
+    }
+
+    /// Copy children or packed elements of from, a record of source, for its copy to
+    void CopyContent( const CompactTree& source, const CompactTree::Record& from, CompactTree::Record& to )
+    {
+        switch ( from.Packed() )
+        {
+            case CompactTree::Packing::integers:
+                to.first = static_cast<std::uint32_t>( tree.integers.size() );
+                tree.integers.insert( tree.integers.end(), source.integers.begin() + from.first,
+                                      source.integers.begin() + from.first + from.Length() );
+                tree.integerTexts.insert( tree.integerTexts.end(), source.integerTexts.begin() + from.first,
+                                          source.integerTexts.begin() + from.first + from.Length() );
+                return;
+
+            case CompactTree::Packing::reals:
+                to.first = static_cast<std::uint32_t>( tree.reals.size() );
+                tree.reals.insert( tree.reals.end(), source.reals.begin() + from.first,
+                                   source.reals.begin() + from.first + from.Length() );
+                tree.realTexts.insert( tree.realTexts.end(), source.realTexts.begin() + from.first,
+                                       source.realTexts.begin() + from.first + from.Length() );
+                return;
+
+            case CompactTree::Packing::none:
+                break;
+        }
+
+        const std::uint32_t first{ static_cast<std::uint32_t>( tree.nodes.size() ) };
+
+        to.first = first;
+        tree.nodes.insert( tree.nodes.end(), source.nodes.begin() + from.first,
+                           source.nodes.begin() + from.first + from.count );
+
+        for ( std::uint32_t i{ 0 }; i < from.count; ++i )
+        {
+            const CompactTree::Record& child{ source.nodes[from.first + i] };
+
+            if ( child.count )
+            {
+                CompactTree::Record copy{ tree.nodes[first + i] };
+                CopyContent( source, child, copy );
+                tree.nodes[first + i] = copy;
+            }
+        }
+    }
+
+    CompactTree&                                  tree;
+    std::vector<std::vector<CompactTree::Record>> levels;  ///< Pending children per open level
+    std::size_t                                   depth{ 0 };
+    std::size_t                                   last{ none };  ///< Index of the last child in levels[depth]
+    std::vector<std::size_t>                      entered;       ///< Index of each open node in its level
+    std::vector<std::pair<std::size_t, std::size_t>> included;   ///< Depth and last child before each include
+    std::string_view                              source;
+    std::size_t                                   packMinSize{ 0 };
+    std::vector<std::int64_t>                     packedIntegers;  ///< Scratch for Pack()
+    std::vector<double>                           packedReals;
+};
+
+// -----------------------------------------------------------------------------
+/// Feed ptree content to a parser handler, keys it rejects are skipped
+template<typename Handler>
+void EmitPtree( const bpt::ptree& pt, Handler& handler )
+{
+    for ( const auto& kv : pt )
+    {
+        if ( !detail::AcceptKey( handler, kv.first ) )
+        {
+            continue;
+        }
+
+        if ( !kv.second.data().empty() )
+        {
+            handler.Value( kv.second.data() );
+        }
+
+        if ( !kv.second.empty() )
+        {
+            handler.Enter();
+            EmitPtree( kv.second, handler );
+            handler.Leave();
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// CompactTree definition
+// -----------------------------------------------------------------------------
+inline void CompactTree::ConvertScalars()
+{
+    scalars.resize( nodes.size() );
+
+    for ( std::size_t i{ 0 }; i < nodes.size(); ++i )
+    {
+        // Trimmed as FromChars() trims, so typed reads agree with and without scalars
+        const std::string_view data{ detail::TrimSpace( nodes[i].data.View() ) };
+
+        if ( data.empty() )
+        {
+            scalars[i] = std::monostate();
+        }
+        else if ( data == "true" || data == "false" )
+        {
+            scalars[i] = data == "true";
+        }
+        else if ( const auto integer{ FromChars<std::int64_t>( data ) } )
+        {
+            scalars[i] = *integer;
+        }
+        else if ( const auto real{ FromChars<double>( data ) } )
+        {
+            scalars[i] = *real;
+        }
+        else
+        {
+            scalars[i] = std::monostate();
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+inline void CompactTree::BuildKeyIndex()
+{
+    keyOrder.resize( nodes.size() );
+
+    for ( const Record& record : nodes )
+    {
+        const std::uint32_t count{ record.Children() };
+        const auto          block{ keyOrder.begin() + record.first };
+
+        for ( std::uint32_t i{ 0 }; i < count; ++i )
+        {
+            block[i] = i;
+        }
+
+        // Stable, so children with equal keys stay in document order
+        std::stable_sort( block, block + count, [&]( std::uint32_t a, std::uint32_t b )
+        {
+            return nodes[record.first + a].key.View() < nodes[record.first + b].key.View();
+        } );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// CompactNode definition
+// -----------------------------------------------------------------------------
+inline std::string_view CompactNode::Key() const  { return tree->nodes[index].key.View(); }
+inline std::string_view CompactNode::Data() const { return tree->nodes[index].data.View(); }
+inline std::size_t      CompactNode::Size() const { return tree->nodes[index].Children(); }
+
+// -----------------------------------------------------------------------------
+inline std::span<const std::int64_t> CompactNode::Integers() const
+{
+    const CompactTree::Record& record{ tree->nodes[index] };
+
+    if ( record.Packed() != CompactTree::Packing::integers )
+    {
+        return {};
+    }
+    return { tree->integers.data() + record.first, record.Length() };
+}
+
+// -----------------------------------------------------------------------------
+inline std::span<const double> CompactNode::Reals() const
+{
+    const CompactTree::Record& record{ tree->nodes[index] };
+
+    if ( record.Packed() != CompactTree::Packing::reals )
+    {
+        return {};
+    }
+    return { tree->reals.data() + record.first, record.Length() };
+}
+
+// -----------------------------------------------------------------------------
+inline std::size_t CompactNode::Elements() const
+{
+    const CompactTree::Record& record{ tree->nodes[index] };
+    return record.Packed() == CompactTree::Packing::none ? 0 : record.Length();
+}
+
+// -----------------------------------------------------------------------------
+inline std::optional<std::string> CompactNode::Element( std::size_t i ) const
+{
+    if ( i >= Elements() )
+    {
+        return std::nullopt;
+    }
+
+    const CompactTree::Record& record{ tree->nodes[index] };
+    const auto&                texts{ record.Packed() == CompactTree::Packing::integers ? tree->integerTexts
+                                                                                        : tree->realTexts };
+    return std::string( texts[record.first + i].View() );
+}
+
+// -----------------------------------------------------------------------------
+inline CompactNode CompactNode::Child( std::size_t i ) const
+{
+    return { *tree, tree->nodes[index].first + static_cast<std::uint32_t>( i ) };
+}
+
+// -----------------------------------------------------------------------------
+inline std::optional<CompactNode> CompactNode::At( std::size_t i ) const
+{
+    if ( i >= Size() )
+    {
+        return std::nullopt;
+    }
+    return Child( i );
+}
+
+// -----------------------------------------------------------------------------
+inline std::optional<CompactNode> CompactNode::Find( std::string_view key ) const
+{
+    if ( tree->HasKeyIndex() )
+    {
+        const KeyRange range{ EqualRange( key ) };
+        return range.Empty() ? std::nullopt : std::optional<CompactNode>( range[0] );
+    }
+
+    for ( std::size_t i{ 0 }; i < Size(); ++i )
+    {
+        if ( Child( i ).Key() == key )
+        {
+            return Child( i );
+        }
+    }
+    return std::nullopt;
+}
+
+// -----------------------------------------------------------------------------
+inline CompactNode::KeyRange CompactNode::EqualRange( std::string_view key ) const
+{
+    const CompactTree::Record& record{ tree->nodes[index] };
+    KeyRange                   range( *this );
+
+    if ( tree->HasKeyIndex() )
+    {
+        const std::span<const std::uint32_t> block( tree->keyOrder.data() + record.first, record.Children() );
+
+        auto keyOf = [&]( std::uint32_t i ) { return tree->nodes[record.first + i].key.View(); };
+
+        const auto [begin, end]{ std::ranges::equal_range( block, key, {}, keyOf ) };
+        range.offsets = { begin, end };
+        return range;
+    }
+
+    for ( std::uint32_t i{ 0 }; i < record.Children(); ++i )
+    {
+        if ( Child( i ).Key() == key )
+        {
+            range.owned.push_back( i );
+        }
+    }
+    return range;
+}
+
+// -----------------------------------------------------------------------------
+inline std::optional<CompactNode> CompactNode::FindPath( std::string_view path, char separator ) const
+{
+    std::optional<CompactNode> current{ *this };
+
+    while ( current && !path.empty() )
+    {
+        const std::size_t sep{ path.find( separator ) };
+
+        current = current->Find( path.substr( 0, sep ) );
+        path    = sep == std::string_view::npos ? std::string_view() : path.substr( sep + 1 );
+    }
+    return current;
+}
+
+// -----------------------------------------------------------------------------
+template<FastConvertible V>
+std::optional<V> CompactNode::GetValue() const
+{
+    if ( tree->scalars.empty() )
+    {
+        return FromChars<V>( Data() );
+    }
+
+    const CompactTree::Scalar& scalar{ tree->scalars[index] };
+
+    if constexpr ( std::is_same_v<V, bool> )
+    {
+        if ( const auto* value{ std::get_if<bool>( &scalar ) } )
+        {
+            return *value;
+        }
+    }
+    else if constexpr ( std::is_integral_v<V> )
+    {
+        if ( const auto* value{ std::get_if<std::int64_t>( &scalar ) } )
+        {
+            return std::in_range<V>( *value ) ? std::optional<V>( static_cast<V>( *value ) ) : std::nullopt;
+        }
+    }
+    else if constexpr ( std::is_same_v<V, double> )
+    {
+        if ( const auto* value{ std::get_if<double>( &scalar ) } )
+        {
+            return *value;
+        }
+        if ( const auto* value{ std::get_if<std::int64_t>( &scalar ) } )
+        {
+            return static_cast<double>( *value );
+        }
+    }
+
+    if ( std::holds_alternative<std::monostate>( scalar ) )
+    {
+        return std::nullopt;
+    }
+    // Other combinations, e.g. 0/1 read as bool, are converted from the text
+    return FromChars<V>( Data() );
+}
+
+// -----------------------------------------------------------------------------
+inline bpt::ptree CompactNode::ToPtree() const
+{
+    bpt::ptree pt{ std::string( Data() ) };
+
+    for ( const CompactNode child : *this )
+    {
+        pt.push_back( { std::string( child.Key() ), child.ToPtree() } );
+    }
+
+    for ( std::size_t i{ 0 }; i < Elements(); ++i )
+    {
+        pt.push_back( { std::string(), bpt::ptree( *Element( i ) ) } );
+    }
+    return pt;
+}
+
+// -----------------------------------------------------------------------------
+inline CompactNode::Iterator CompactNode::begin() const { return { *this, 0 }; }
+inline CompactNode::Iterator CompactNode::end() const   { return { *this, Size() }; }
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeCompact_H
@@ -0,0 +1,328 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Embedded ptree: a loaded tree compiled into the program as constexpr tables.
+// WriteEmbedded() generates a header with the tables, PtreeEmbedder does it at
+// build time (see Embedder/CMakeLists.txt for the ptree_embed() function).
+// The tables are constant-initialized read-only data: there is no parsing and
+// no initialization at run time, and lookups can be evaluated at compile time.
+//
+// Layout of a generated header, in a namespace given to the generator:
+//   nodes   EmbeddedRecord per node, in breadth-first order, so the children
+//           of a node are contiguous
+//   sorted  per node, child count x child position ordered by key, equal keys
+//           in document order
+//   tree    EmbeddedPtree over nodes and sorted
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeEmbedded_H
+#define PtreeEmbedded_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <optional>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+#include <boost/property_tree/ptree.hpp>
+#include "PtreeTranslator.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+namespace bpt = boost::property_tree;
+
+// -----------------------------------------------------------------------------
+/// Node of an embedded ptree
+struct EmbeddedRecord
+{
+    std::string_view key;
+    std::string_view data;
+    std::uint32_t    size;      ///< Number of children
+    std::uint32_t    children;  ///< Index of the first child in the node table
+    std::uint32_t    sorted;    ///< Offset of the sorted table
+};
+
+// -----------------------------------------------------------------------------
+// EmbeddedNode : view of one node in an embedded ptree
+// -----------------------------------------------------------------------------
+class EmbeddedNode
+{
+public:
+    constexpr EmbeddedNode( std::span<const EmbeddedRecord> nodes, std::span<const std::uint32_t> sorted, std::uint32_t index )
+        : nodes( nodes ), sorted( sorted ), index( index )
+    {
+    }
+
+    constexpr std::string_view Key() const  { return nodes[index].key; }
+    constexpr std::string_view Data() const { return nodes[index].data; }
+    constexpr std::size_t      Size() const { return nodes[index].size; }
+    constexpr bool             Empty() const { return Size() == 0; }
+
+    /// Child in document order
+    constexpr EmbeddedNode Child( std::size_t i ) const
+    {
+        return { nodes, sorted, static_cast<std::uint32_t>( nodes[index].children + i ) };
+    }
+
+    /// First child with key, binary search
+    constexpr std::optional<EmbeddedNode> Find( std::string_view key ) const
+    {
+        const std::size_t pos{ LowerBound( key ) };
+
+        if ( pos == Size() || SortedKey( pos ) != key )
+        {
+            return std::nullopt;
+        }
+        return Child( sorted[nodes[index].sorted + pos] );
+    }
+
+    /// Number of children with key
+    constexpr std::size_t Count( std::string_view key ) const
+    {
+        std::size_t count{ 0 };
+
+        for ( std::size_t pos{ LowerBound( key ) }; pos < Size() && SortedKey( pos ) == key; ++pos )
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    /// Descendant by path
+    /// @param path Keys separated by separator, empty path is this node
+    constexpr std::optional<EmbeddedNode> FindPath( std::string_view path, char separator = '.' ) const
+    {
+        std::optional<EmbeddedNode> current{ *this };
+
+        while ( current && !path.empty() )
+        {
+            const std::size_t sep{ path.find( separator ) };
+
+            current = current->Find( path.substr( 0, sep ) );
+            path    = sep == std::string_view::npos ? std::string_view() : path.substr( sep + 1 );
+        }
+        return current;
+    }
+
+    /// Copy subtree into a ptree
+    bpt::ptree ToPtree() const
+    {
+        bpt::ptree pt{ std::string( Data() ) };
+
+        for ( std::size_t i{ 0 }; i < Size(); ++i )
+        {
+            const EmbeddedNode child{ Child( i ) };
+            pt.push_back( { std::string( child.Key() ), child.ToPtree() } );
+        }
+        return pt;
+    }
+
+private:
+    /// Key of the child at position i of the sorted table
+    constexpr std::string_view SortedKey( std::size_t i ) const
+    {
+        return Child( sorted[nodes[index].sorted + i] ).Key();
+    }
+
+    /// First position in the sorted table with key not less than key
+    constexpr std::size_t LowerBound( std::string_view key ) const
+    {
+        std::size_t first{ 0 };
+        std::size_t count{ Size() };
+
+        while ( count > 0 )
+        {
+            const std::size_t step{ count / 2 };
+
+            if ( SortedKey( first + step ) < key )
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+            {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    std::span<const EmbeddedRecord> nodes;
+    std::span<const std::uint32_t>  sorted;
+    std::uint32_t                   index;
+};
+
+// -----------------------------------------------------------------------------
+// EmbeddedPtree : tables of a generated header
+// -----------------------------------------------------------------------------
+class EmbeddedPtree
+{
+public:
+    constexpr EmbeddedPtree( std::span<const EmbeddedRecord> nodes, std::span<const std::uint32_t> sorted )
+        : nodes( nodes ), sorted( sorted )
+    {
+    }
+
+    constexpr EmbeddedNode Root() const { return { nodes, sorted, 0 }; }
+
+    /// Number of nodes, including the root
+    constexpr std::size_t Nodes() const { return nodes.size(); }
+
+    /// Descendant of the root by dotted path
+    constexpr std::optional<EmbeddedNode> Find( std::string_view path, char separator = '.' ) const
+    {
+        return Root().FindPath( path, separator );
+    }
+
+    /// Data of the descendant of the root by dotted path
+    constexpr std::optional<std::string_view> GetData( std::string_view path, char separator = '.' ) const
+    {
+        const auto node{ Find( path, separator ) };
+        return node ? std::optional( node->Data() ) : std::nullopt;
+    }
+
+    /// Value of the descendant of the root by dotted path
+    /// @return Nothing if there is no such node or its data is not a V
+    template<FastConvertible V>
+    std::optional<V> Get( std::string_view path, char separator = '.' ) const
+    {
+        const auto data{ GetData( path, separator ) };
+        return data ? FromChars<V>( *data ) : std::nullopt;
+    }
+
+private:
+    std::span<const EmbeddedRecord> nodes;
+    std::span<const std::uint32_t>  sorted;
+};
+
+// -----------------------------------------------------------------------------
+// Generator
+// -----------------------------------------------------------------------------
+/// C++ header declaring the tables of an embedded ptree, see file comment
+/// @param ns Namespace of the tables, may be nested ("a::b")
+/// @param source Description of where the tree came from, for the header comment
+inline std::string GenerateEmbedded( const bpt::ptree& pt, std::string_view ns, std::string_view source );
+
+/// Write header generated by GenerateEmbedded() to file
+/// @return false if the file could not be written
+inline bool WriteEmbedded( const bpt::ptree& pt, const std::filesystem::path& fsPath, std::string_view ns,
+                           std::string_view source )
+{
+    std::ofstream stream( fsPath, std::ios::binary );
+    stream << GenerateEmbedded( pt, ns, source );
+    return stream.good();
+}
+
+// -----------------------------------------------------------------------------
+namespace detail
+{
+/// C++ string_view initializer of str, bytes other than printable ASCII as octal escapes
+inline std::string EmbeddedString( std::string_view str )
+{
+    std::string out{ "{ \"" };
+
+    for ( const char c : str )
+    {
+        const auto u{ static_cast<unsigned char>( c ) };
+
+        if ( c == '"' || c == '\\' )
+        {
+            out += '\\';
+            out += c;
+        }
+        else if ( u >= 0x20 && u < 0x7f )
+        {
+            out += c;
+        }
+        else
+        {
+            out += '\\';
+            out += static_cast<char>( '0' + ( u >> 6 ) );
+            out += static_cast<char>( '0' + ( ( u >> 3 ) & 7 ) );
+            out += static_cast<char>( '0' + ( u & 7 ) );
+        }
+    }
+    return out + "\", " + std::to_string( str.size() ) + " }";
+}
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Generator definition
+// -----------------------------------------------------------------------------
+inline std::string GenerateEmbedded( const bpt::ptree& pt, std::string_view ns, std::string_view source )
+{
+    struct Item
+    {
+        const std::string* key;
+        const bpt::ptree*  tree;
+        std::uint32_t      children{ 0 };
+        std::uint32_t      sorted{ 0 };
+    };
+
+    // Nodes in breadth-first order, children are appended when their parent is reached
+    static const std::string   noKey;
+    std::vector<Item>          items{ { &noKey, &pt } };
+    std::vector<std::uint32_t> sorted;
+
+    for ( std::size_t i{ 0 }; i < items.size(); ++i )
+    {
+        const bpt::ptree& tree{ *items[i].tree };
+        const std::size_t first{ items.size() };
+
+        items[i].children = static_cast<std::uint32_t>( first );
+        items[i].sorted   = static_cast<std::uint32_t>( sorted.size() );
+
+        for ( const auto& kv : tree )
+        {
+            items.push_back( { &kv.first, &kv.second } );
+        }
+
+        for ( std::size_t c{ 0 }; c < tree.size(); ++c )
+        {
+            sorted.push_back( static_cast<std::uint32_t>( c ) );
+        }
+
+        std::stable_sort( sorted.begin() + items[i].sorted, sorted.end(),
+                          [&]( std::uint32_t a, std::uint32_t b ) { return *items[first + a].key < *items[first + b].key; } );
+    }
+
+    std::string out;
+
+    out += "// Generated from " + std::string( source ) + ", do not edit\n";
+    out += "#pragma once\n\n";
+    out += "#include <array>\n";
+    out += "#include <cstdint>\n";
+    out += "#include \"PtreeEmbedded.h\"\n\n";
+    out += "namespace " + std::string( ns ) + "\n{\n";
+
+    out += "inline constexpr std::array<ptree_loader::EmbeddedRecord, " + std::to_string( items.size() ) + "> nodes{ {\n";
+    for ( const auto& item : items )
+    {
+        out += "    { " + detail::EmbeddedString( *item.key ) + ", " + detail::EmbeddedString( item.tree->data() ) + ", " +
+               std::to_string( item.tree->size() ) + ", " + std::to_string( item.children ) + ", " +
+               std::to_string( item.sorted ) + " },\n";
+    }
+    out += "} };\n\n";
+
+    out += "inline constexpr std::array<std::uint32_t, " + std::to_string( sorted.size() ) + "> sorted{ {";
+    for ( std::size_t i{ 0 }; i < sorted.size(); ++i )
+    {
+        out += ( i % 16 == 0 ? "\n    " : " " ) + std::to_string( sorted[i] ) + ',';
+    }
+    out += "\n} };\n\n";
+
+    out += "inline constexpr ptree_loader::EmbeddedPtree tree{ nodes, sorted };\n";
+    out += "} // namespace " + std::string( ns ) + "\n";
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeEmbedded_H
@@ -0,0 +1,213 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// File systems the loader resolves and reads include files through.
+//   DiskFileSystem   : the real disk through std::filesystem, the default
+//   MemoryFileSystem : files held in memory, no syscalls
+//   Bundle           : files in a mapped archive, see PtreeBundle.h
+//   OverlayFileSystem: one file in memory over another file system, used to
+//                      load text held by the caller
+// Virtual file systems use absolute, lexically normal paths from the root "/".
+// Relative paths are taken from the root, ".." above the root stays at the
+// root, as on disk. They have no symbolic links.
+// Implementations must allow concurrent const calls, the pipelined load
+// resolves and reads on its own thread.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeFileSystem_H
+#define PtreeFileSystem_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <optional>
+#include <filesystem>
+#include "PtreeParsers.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+/// Include path after canonicalization
+struct ResolvedPath
+{
+    std::filesystem::path path;
+    bool                  exists{ false };
+};
+
+// -----------------------------------------------------------------------------
+// FileSystem : interface
+// -----------------------------------------------------------------------------
+class FileSystem
+{
+public:
+    virtual ~FileSystem() = default;
+
+    /// Canonical form and existence of a path
+    virtual ResolvedPath Resolve( const std::filesystem::path& path ) const = 0;
+
+    /// Content of a resolved file
+    /// @param storage Receives the content unless it can be viewed in place
+    /// @return View of the content, nothing if the file could not be read
+    virtual std::optional<std::string_view> Read( const std::filesystem::path& path, std::string& storage ) const = 0;
+
+    /// Directory relative root paths are taken from
+    virtual std::filesystem::path Root() const { return "/"; }
+
+    /// File whose change invalidates a load that resolved path, empty if none
+    virtual std::filesystem::path Dependency( const ResolvedPath& resolved ) const = 0;
+
+    /// Whether paths are disk paths, which can be shared with other loaders
+    virtual bool IsDisk() const { return false; }
+
+    /// Path of a virtual file system, see file comment
+    static std::filesystem::path Normalize( const std::filesystem::path& path )
+    {
+        return ( std::filesystem::path( "/" ) / path ).lexically_normal();
+    }
+};
+
+// -----------------------------------------------------------------------------
+// DiskFileSystem
+// -----------------------------------------------------------------------------
+class DiskFileSystem final : public FileSystem
+{
+public:
+    ResolvedPath Resolve( const std::filesystem::path& path ) const override
+    {
+        ResolvedPath    resolved;
+        std::error_code ec;
+
+        resolved.path   = std::filesystem::weakly_canonical( path, ec );
+        resolved.path   = ec ? path : resolved.path;
+        resolved.exists = std::filesystem::exists( resolved.path, ec );
+        return resolved;
+    }
+
+    std::optional<std::string_view> Read( const std::filesystem::path& path, std::string& storage ) const override
+    {
+        if ( !detail::ReadFile( path.string(), storage ) )
+        {
+            return std::nullopt;
+        }
+        return storage;
+    }
+
+    std::filesystem::path Root() const override { return std::filesystem::current_path(); }
+
+    /// A missing file is represented by its nearest existing parent directory,
+    /// whose timestamp changes when the file is created
+    std::filesystem::path Dependency( const ResolvedPath& resolved ) const override
+    {
+        std::filesystem::path fsDependency{ resolved.path };
+
+        if ( !resolved.exists )
+        {
+            std::error_code ec;
+
+            do
+            {
+                fsDependency = fsDependency.parent_path();
+            } while ( fsDependency.has_relative_path() && !std::filesystem::exists( fsDependency, ec ) );
+        }
+        return fsDependency;
+    }
+
+    bool IsDisk() const override { return true; }
+};
+
+/// Default file system of loaders
+inline const DiskFileSystem diskFileSystem;
+
+// -----------------------------------------------------------------------------
+// MemoryFileSystem
+// -----------------------------------------------------------------------------
+class MemoryFileSystem final : public FileSystem
+{
+public:
+    /// Add or replace file, content is copied
+    void Add( const std::filesystem::path& path, std::string content )
+    {
+        const std::string key{ Normalize( path ).generic_string() };
+        files[key] = owned.insert_or_assign( key, std::move( content ) ).first->second;
+    }
+
+    /// Add or replace file without copying
+    /// @param content Text that outlives loads and compact trees with retained sources
+    void AddView( const std::filesystem::path& path, std::string_view content )
+    {
+        const std::string key{ Normalize( path ).generic_string() };
+        owned.erase( key );
+        files[key] = content;
+    }
+
+    /// Number of files
+    std::size_t Size() const { return files.size(); }
+
+    ResolvedPath Resolve( const std::filesystem::path& path ) const override
+    {
+        ResolvedPath resolved;
+        resolved.path   = Normalize( path );
+        resolved.exists = files.contains( resolved.path.generic_string() );
+        return resolved;
+    }
+
+    std::optional<std::string_view> Read( const std::filesystem::path& path, std::string& ) const override
+    {
+        const auto it{ files.find( Normalize( path ).generic_string() ) };
+        return it != files.end() ? std::optional( it->second ) : std::nullopt;
+    }
+
+    std::filesystem::path Dependency( const ResolvedPath& ) const override { return {}; }
+
+private:
+    std::unordered_map<std::string, std::string_view> files;  ///< Path to content
+    std::unordered_map<std::string, std::string>      owned;  ///< Content added by copy
+};
+
+// -----------------------------------------------------------------------------
+// OverlayFileSystem : one file in memory over another file system
+// -----------------------------------------------------------------------------
+class OverlayFileSystem final : public FileSystem
+{
+public:
+    /// @param base File system of all other files
+    /// @param path Path of the file, as resolved by base
+    /// @param text Content of the file, outlives the overlay
+    OverlayFileSystem( const FileSystem& base, std::filesystem::path path, std::string_view text )
+        : base( base ), path( std::move( path ) ), text( text )
+    {
+    }
+
+    ResolvedPath Resolve( const std::filesystem::path& fsPath ) const override
+    {
+        ResolvedPath resolved{ base.Resolve( fsPath ) };
+        resolved.exists = resolved.exists || resolved.path == path;
+        return resolved;
+    }
+
+    std::optional<std::string_view> Read( const std::filesystem::path& fsPath, std::string& storage ) const override
+    {
+        return fsPath == path ? std::optional( text ) : base.Read( fsPath, storage );
+    }
+
+    std::filesystem::path Root() const override { return base.Root(); }
+
+    std::filesystem::path Dependency( const ResolvedPath& resolved ) const override
+    {
+        return resolved.path == path ? std::filesystem::path() : base.Dependency( resolved );
+    }
+
+private:
+    const FileSystem&     base;
+    std::filesystem::path path;
+    std::string_view      text;
+};
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeFileSystem_H
@@ -0,0 +1,236 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Resolved include graph recorded by PtreeLoader.
+// Nodes are canonical file paths, edges are "IncludeFile" directives in the
+// order they appear in the including file. Every node carries its size, parse
+// time, number of loads and number of nodes it contributes, which is enough to
+// spot hot shared fragments, deep include chains and dead includes.
+// The graph can be exported as Graphviz DOT or JSON.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeGraph_H
+#define PtreeGraph_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
+#include <set>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+#include "PtreeUtils.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+// IncludeGraph
+// -----------------------------------------------------------------------------
+struct IncludeGraph
+{
+    using Duration = std::chrono::nanoseconds;
+
+    struct Node
+    {
+        std::string   path;                  ///< Canonical file path
+        bool          exists{ false };
+        std::uint64_t size{ 0 };             ///< File size in bytes
+        Duration      parseTime{};           ///< Accumulated over all loads
+        std::uint64_t loads{ 0 };            ///< Times the file was loaded
+        std::uint64_t contributedNodes{ 0 }; ///< Top-level nodes other than includes, per load
+        std::uint64_t errors{ 0 };
+        int           depth{ 0 };            ///< Deepest include chain the file was reached by
+    };
+
+    struct Edge
+    {
+        std::size_t from;
+        std::size_t to;
+        std::size_t order;     ///< 1-based position among includes of the parent
+        std::string directive; ///< Path as written in the parent
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+
+    /// Find or add node
+    /// @return Node index
+    std::size_t AddNode( const std::string& path );
+
+    /// Add edge, repeated loads of the same parent don't duplicate it
+    void AddEdge( std::size_t from, std::size_t to, std::size_t order, const std::string& directive );
+
+    /// Missing file, or a file that neither contributes nodes nor includes anything
+    /// O(edges), see DeadNodes() for all nodes
+    bool IsDead( std::size_t node ) const;
+
+    /// IsDead() of every node, O(nodes + edges)
+    std::vector<bool> DeadNodes() const;
+
+    /// Export as Graphviz DOT
+    std::string ToDot() const;
+
+    /// Export as JSON object with "nodes" and "edges" arrays
+    std::string ToJson() const;
+
+private:
+    std::unordered_map<std::string, std::size_t>  index;
+    std::set<std::pair<std::size_t, std::size_t>> edgeKeys;
+};
+
+// -----------------------------------------------------------------------------
+// IncludeGraph definition
+// -----------------------------------------------------------------------------
+inline std::size_t IncludeGraph::AddNode( const std::string& path )
+{
+    const auto [it, inserted]{ index.try_emplace( path, nodes.size() ) };
+
+    if ( inserted )
+    {
+        nodes.push_back( { path } );
+    }
+    return it->second;
+}
+
+// -----------------------------------------------------------------------------
+inline void IncludeGraph::AddEdge( std::size_t from, std::size_t to, std::size_t order, const std::string& directive )
+{
+    if ( edgeKeys.emplace( from, order ).second )
+    {
+        edges.push_back( { from, to, order, directive } );
+    }
+}
+
+// -----------------------------------------------------------------------------
+inline bool IncludeGraph::IsDead( std::size_t node ) const
+{
+    if ( !nodes[node].exists )
+    {
+        return true;
+    }
+
+    if ( nodes[node].contributedNodes != 0 )
+    {
+        return false;
+    }
+
+    for ( const auto& edge : edges )
+    {
+        if ( edge.from == node )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+inline std::vector<bool> IncludeGraph::DeadNodes() const
+{
+    std::vector<bool> includes( nodes.size(), false );
+    std::vector<bool> dead( nodes.size() );
+
+    for ( const auto& edge : edges )
+    {
+        includes[edge.from] = true;
+    }
+
+    for ( std::size_t i{ 0 }; i < nodes.size(); ++i )
+    {
+        dead[i] = !nodes[i].exists || ( nodes[i].contributedNodes == 0 && !includes[i] );
+    }
+    return dead;
+}
+
+// -----------------------------------------------------------------------------
+inline std::string IncludeGraph::ToDot() const
+{
+    using Milli = std::chrono::duration<double, std::milli>;
+
+    const std::vector<bool> dead{ DeadNodes() };
+    std::stringstream       ss;
+
+    ss << "digraph includes {\n"
+       << "    node [shape=box];\n";
+
+    for ( std::size_t i{ 0 }; i < nodes.size(); ++i )
+    {
+        const Node& n{ nodes[i] };
+
+        ss << "    n" << i << " [label=\"" << detail::DotEscape( n.path );
+
+        if ( n.exists )
+        {
+            ss << "\\n" << n.size << " B, " << Milli( n.parseTime ).count() << " ms, x" << n.loads;
+        }
+        ss << '"';
+
+        if ( !n.exists )
+        {
+            ss << ", style=dashed, color=red";
+        }
+        else if ( dead[i] )
+        {
+            ss << ", color=orange";
+        }
+        ss << "];\n";
+    }
+
+    for ( const auto& e : edges )
+    {
+        ss << "    n" << e.from << " -> n" << e.to << " [label=\"" << e.order << "\"];\n";
+    }
+
+    ss << "}\n";
+    return ss.str();
+}
+
+// -----------------------------------------------------------------------------
+inline std::string IncludeGraph::ToJson() const
+{
+    const std::vector<bool> dead{ DeadNodes() };
+    std::stringstream       ss;
+    const char*             delim{ "" };
+
+    ss << "{\"nodes\":[";
+
+    for ( std::size_t i{ 0 }; i < nodes.size(); ++i )
+    {
+        const Node& n{ nodes[i] };
+
+        ss << delim << "\n{\"id\":" << i
+           << ",\"path\":\"" << detail::JsonEscape( n.path ) << '"'
+           << ",\"exists\":" << ( n.exists ? "true" : "false" )
+           << ",\"size\":" << n.size
+           << ",\"parse_seconds\":" << std::chrono::duration<double>( n.parseTime ).count()
+           << ",\"loads\":" << n.loads
+           << ",\"contributed_nodes\":" << n.contributedNodes
+           << ",\"errors\":" << n.errors
+           << ",\"depth\":" << n.depth
+           << ",\"dead\":" << ( dead[i] ? "true" : "false" ) << '}';
+        delim = ",";
+    }
+
+    ss << "\n],\"edges\":[";
+    delim = "";
+
+    for ( const auto& e : edges )
+    {
+        ss << delim << "\n{\"from\":" << e.from << ",\"to\":" << e.to << ",\"order\":" << e.order
+           << ",\"directive\":\"" << detail::JsonEscape( e.directive ) << "\"}";
+        delim = ",";
+    }
+
+    ss << "\n]}\n";
+    return ss.str();
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeGraph_H
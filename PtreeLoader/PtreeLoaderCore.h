@@ -0,0 +1,1622 @@
+﻿// =============================================================================
+// Ptree Loader
+// =============================================================================
+// An utility class that enables loading Boost.PropertyTree with support for "include" directives.
+// Boost.PropertyTree supports four file formats for loading values : XML / JSON / INI / INFO
+// However, only one of those formats (INFO) supports "include" directive functionality
+// natively and it is also limited to absolute paths.
+// This class enhances support for "include" functionality
+// and allows to use it with several file formats (XML/JSON/INFO).
+//
+// This is achieved by reserving a special key, "IncludeFile", which is interpreted as "include" directive.
+// Ptree files are loaded recursively from locations pointed by "IncludeFile" keys.
+// Filepaths can be absolute or relative (to the parent file).
+//
+// INI format doesn't allow duplicate keys so it is not supported for "include" functionality.
+//
+// This class also provides utility methods for printing ptree content and diagnostic.
+//
+// This header has no Boost.PropertyTree parsers. Include the header of the
+// formats in use, PtreeLoaderXml.h, PtreeLoaderJson.h or PtreeLoaderInfo.h,
+// or PtreeLoader.h for all of them.
+//
+// Defining PTREE_LOADER_LIBRARY in every TU uses the compiled ptree_loader
+// library instead (see Library/CMakeLists.txt): PtreeLoader<T> is explicitly
+// instantiated there and format headers do not include Boost parsers.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeLoaderCore_H
+#define PtreeLoaderCore_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <optional>
+#include <sstream>
+#include <boost/property_tree/ptree.hpp>
+#include <filesystem>
+#include <exception>
+#include <unordered_map>
+#include <unordered_set>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <expected>
+#include <vector>
+#include <thread>
+#include "PtreeTranslator.h"
+#include "PtreeStats.h"
+#include "PtreeTrace.h"
+#include "PtreeParsers.h"
+#include "PtreeCache.h"
+#include "PtreeGraph.h"
+#include "PtreeBinary.h"
+#include "PtreeMemo.h"
+#include "PtreeCompact.h"
+#include "PtreeProjection.h"
+#include "PtreePipeline.h"
+#include "PtreeScanner.h"
+#include "PtreePrefetch.h"
+#include "PtreeFileSystem.h"
+#include "PtreeBundle.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+namespace bpt = boost::property_tree;
+namespace fs  = std::filesystem;
+
+// -----------------------------------------------------------------------------
+enum class PtreeFileFormat
+{
+    xml,
+    json,
+    info
+};
+
+// -----------------------------------------------------------------------------
+/// What TryLoad() keeps from a file that has parse errors
+enum class ErrorPolicy
+{
+    discardFile,  ///< File contributes nothing, as with Load()
+    keepPrefix    ///< Well-formed content before the first error is merged
+};
+
+/// Result of TryLoad(), every error found in the include graph
+using LoadResult = std::expected<void, std::vector<ParseError>>;
+
+// -----------------------------------------------------------------------------
+/// Boost.PropertyTree reader and writer of a format, specialized in its format header:
+///   static void Read( const std::string& fname, bpt::ptree& pt );    // throws on errors
+///   static void Write( std::ostream& stream, const bpt::ptree& pt );
+/// XML, whose only parser is Boost's, also parses text in memory:
+///   static bool Read( std::string_view text, const std::string& fname, bpt::ptree& pt,
+///                     std::vector<ParseError>& errors );              // false on errors
+template<PtreeFileFormat T>
+struct FormatParser;
+
+/// Format header functions are defined once, in the library, if it is used
+#ifdef PTREE_LOADER_LIBRARY
+#define PTREE_LOADER_INLINE
+#else
+#define PTREE_LOADER_INLINE inline
+#endif
+
+// -----------------------------------------------------------------------------
+// PtreeLoader declaration
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+class PtreeLoader
+{
+public:
+    /// Constructs PtreeLoader
+    /// @param root ptree to load into
+    explicit PtreeLoader( bpt::ptree& root ) : root( root ), memo( root ) {}
+    PtreeLoader( const PtreeLoader& )             = delete;
+    PtreeLoader& operator=( const PtreeLoader& )  = delete;
+    PtreeLoader( PtreeLoader&& )                  = delete;
+    PtreeLoader& operator=( PtreeLoader&& )       = delete;
+    ~PtreeLoader()                                = default;
+
+    /// Load ptree from file
+    /// @param fsPath Absolute or relative file path
+    void Load( const fs::path& fsPath );
+
+    /// Load ptree from file without throwing
+    /// INFO and JSON files are read by the non-throwing parsers and every error
+    /// is reported with its location, XML files are still read by Boost.
+    /// @param fsPath Absolute or relative file path
+    /// @param policy What to keep from files with parse errors
+    /// @return Nothing on success, otherwise all errors found
+    LoadResult TryLoad( const fs::path& fsPath, ErrorPolicy policy = ErrorPolicy::discardFile );
+
+    /// Load ptree from text in memory, parsed in place
+    /// Loads like any file at fsPath that holds the text: includes are
+    /// resolved from its directory and it names the text in diagnostics.
+    /// Other files are read from the file system, without the shared cache.
+    /// @param text Content of the root file
+    /// @param fsPath Absolute or relative path the text stands for, need not exist
+    void Load( std::string_view text, const fs::path& fsPath );
+
+    /// Load ptree from text in memory without throwing, see Load( text, fsPath ) and TryLoad()
+    LoadResult TryLoad( std::string_view text, const fs::path& fsPath, ErrorPolicy policy = ErrorPolicy::discardFile );
+
+    /// Load into compact read-only tree without throwing
+    /// Parses like TryLoad() but builds a CompactTree, the ptree root is not used.
+    /// The shared cache is used for resolved paths only.
+    /// Unlike Load(), which merges a top-level key "a.b" of a file as child b of
+    /// the first root child a, keys are stored as they are: the children of a
+    /// node are one contiguous block, closed before later files are merged.
+    /// @param fsPath Absolute or relative file path
+    /// @param tree Tree to replace with the loaded content
+    /// @param policy What to keep from files with parse errors
+    /// @return Nothing on success, otherwise all errors found
+    LoadResult LoadCompact( const fs::path& fsPath, CompactTree& tree, ErrorPolicy policy = ErrorPolicy::discardFile );
+
+    /// Stream parser events of a file and its includes to visitor, no tree is built
+    /// Visitor has the handler interface of the parsers (see PtreeParsers.h) and
+    ///   void Include( const fs::path& file ); // before the events of each file
+    /// Events of an included file follow its include key, in the order of the
+    /// loaded tree. Events already streamed are not withdrawn when a file has
+    /// errors, as with ErrorPolicy::keepPrefix. The projection applies.
+    /// Top-level keys are streamed as they are, dots included, see LoadCompact().
+    /// @param fsPath Absolute or relative file path
+    /// @param visitor Event receiver
+    /// @return Nothing on success, otherwise all errors found
+    template<typename Visitor>
+    LoadResult Visit( const fs::path& fsPath, Visitor& visitor );
+
+    /// Make LoadCompact() map INFO and JSON files and keep them mapped for the
+    /// lifetime of the tree, which then references their strings instead of
+    /// copying them. Only strings with escape sequences are copied.
+    void SetRetainSources( bool enable ) { retainSources = enable; }
+
+    /// Make LoadCompact() pre-convert scalar values, see CompactTree::ConvertScalars()
+    void SetTypedScalars( bool enable ) { typedScalars = enable; }
+
+    /// Make LoadCompact() store arrays of at least minSize numbers packed, see
+    /// CompactNode::Integers(), Reals() and Element(), 0 disables
+    void SetPackArrays( std::size_t minSize ) { packMinSize = minSize; }
+
+    /// Load only the projected paths, nothing resets it
+    /// Files are read by the non-throwing parsers, which skip the values of other
+    /// keys without building nodes. Include keys at the top level of each file are
+    /// always kept, as they can add any path.
+    void SetProjection( std::optional<Projection> selection )
+    {
+        projection = std::move( selection );
+
+        if ( projection )
+        {
+            projection->Add( includeKey );
+        }
+    }
+
+    /// Make Load() and TryLoad() run file reading and parsing on two threads of
+    /// their own, overlapping I/O with parsing and merging, see PtreePipeline.h
+    /// Files are read by the non-throwing parsers, the result is unchanged.
+    void SetPipeline( bool enable ) { pipelined = enable; }
+
+    /// Find node in the loaded ptree by dotted path, memoized
+    /// Safe for concurrent readers, the memo is invalidated by Load().
+    /// @return Node or nullptr if there is no such path
+    const bpt::ptree* Find( std::string_view path ) const { return memo.Find( path ); }
+
+    /// Get value from the loaded ptree by dotted path, memoized
+    /// Arithmetic types are converted with FastTranslator.
+    template<typename V>
+    std::optional<V> Get( std::string_view path ) const
+    {
+        const bpt::ptree* node{ Find( path ) };
+
+        if constexpr ( FastConvertible<V> )
+        {
+            return node ? FromChars<V>( node->data() ) : std::nullopt;
+        }
+        else if ( const auto value{ node ? node->get_value_optional<V>() : boost::none } )
+        {
+            return *value;
+        }
+        return std::nullopt;
+    }
+
+    /// Forget memoized paths, required after the ptree is modified outside of Load()
+    void InvalidateLookups() { memo.Invalidate(); }
+
+    /// Dump diagnostic
+    std::string DumpDiag() const;
+
+    /// Dump ptree content
+    std::string DumpPtree() const;
+
+    /// Save loaded ptree in binary format, to be queried in place with BinaryPtree
+    /// @param fsPath Output file path
+    /// @return false if the file could not be written
+    bool SaveBinary( const fs::path& fsPath ) const { return WriteBinary( root, fsPath ); }
+
+    /// Load statistics accumulated since construction
+    const LoadStats& Stats() const { return stats; }
+
+    /// Attach trace recorder for load phases, nullptr detaches
+    /// @param recorder Recorder that outlives subsequent Load() calls
+    void SetTracer( TraceRecorder* recorder ) { tracer = recorder; }
+
+    /// Attach cache shared with other loaders, nullptr detaches
+    /// Resolved paths are shared by Load() and TryLoad(), parsed files by TryLoad() only.
+    /// @param sharedCache Cache that outlives subsequent Load() calls
+    void SetCache( LoadCache* sharedCache ) { cache = sharedCache; }
+
+    /// Attach include graph to record into, nullptr detaches
+    /// @param includeGraph Graph that outlives subsequent Load() calls
+    void SetGraph( IncludeGraph* includeGraph ) { graph = includeGraph; }
+
+    /// Attach prefetch list, nullptr detaches
+    /// Loads hint the listed files to the OS first, and a load without errors
+    /// replaces the list with the files it read, in access order.
+    /// @param prefetchList List that outlives subsequent Load() calls
+    void SetPrefetch( PrefetchList* prefetchList ) { prefetch = prefetchList; }
+
+    /// Resolve and read files through a file system other than the disk, nullptr restores the disk
+    /// Relative root paths are taken from its root. The shared cache is used for disk paths only.
+    /// @param files File system, e.g. a MemoryFileSystem or a Bundle, that outlives
+    ///              subsequent Load() calls and compact trees loaded with retained sources
+    void SetFileSystem( const FileSystem* files ) { fileSystem = files ? files : &diskFileSystem; }
+
+    /// Files read since construction, in first-access order
+    /// A missing include is represented by its nearest existing parent directory,
+    /// whose timestamp changes when the file is created. Other file systems
+    /// report their own dependencies, see FileSystem::Dependency().
+    /// Files of INFO #include directives are recorded unless the Boost parser
+    /// read the including file, see PtreeLoaderInfo.h.
+    const std::vector<fs::path>& Dependencies() const { return dependencies; }
+
+    /// Write Makefile/Ninja depfile listing Dependencies()
+    /// @param fsDepfile Depfile path
+    /// @param target Target name the dependencies belong to
+    /// @return false if the depfile could not be written
+    bool WriteDepfile( const fs::path& fsDepfile, const std::string& target ) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /// Storage of the strings of a CompactFragment tree, retained by the
+    /// target tree after merge while the fragment itself is released
+    struct FragmentStrings
+    {
+        MappedFile  source;  ///< Referenced by tree strings if retained
+        StringArena arena;   ///< Arena of the fragment tree
+    };
+
+    /// Parsed file for LoadCompact()
+    struct CompactFragment
+    {
+        CompactTree                      tree;
+        std::shared_ptr<FragmentStrings> strings{ std::make_shared<FragmentStrings>() };
+        std::vector<ParseError>          errors;
+        std::uint64_t             size{ 0 };
+        std::vector<ResolvedPath> directives;  ///< Files of INFO #include directives, for dependencies
+    };
+
+    /// Reads files of INFO #include directives through the file system, relative
+    /// to its root as the Boost parser reads them relative to the working directory
+    class DirectiveReader : public IncludeReader
+    {
+    public:
+        DirectiveReader( const FileSystem& files, std::vector<ResolvedPath>& resolved )
+            : files( files ), resolved( resolved ) {}
+
+        std::optional<std::string_view> Read( std::string_view name, std::string& storage, std::string& fname ) override
+        {
+            const fs::path fsPath{ name };
+
+            resolved.push_back( files.Resolve( fsPath.is_absolute() ? fsPath : files.Root() / fsPath ) );
+            fname = resolved.back().path.string();
+            return resolved.back().exists ? files.Read( resolved.back().path, storage ) : std::nullopt;
+        }
+
+    private:
+        const FileSystem&          files;
+        std::vector<ResolvedPath>& resolved;
+    };
+
+    /// Visit() handler that follows top-level include keys
+    template<typename Visitor>
+    class IncludeFollower;
+
+    /// File on the current include chain, removed from it when the file is done
+    struct IncludeGuard
+    {
+        PtreeLoader& loader;
+        std::string  path;  ///< Set by Prepare() once the file is on the chain
+
+        explicit IncludeGuard( PtreeLoader& l ) : loader( l ) { ++loader.depth; }
+        ~IncludeGuard()
+        {
+            --loader.depth;
+
+            if ( !path.empty() )
+            {
+                loader.includeChain.erase( path );
+            }
+        }
+    };
+
+    void LoadFile( const fs::path& fsPath, const fs::path& fsParentPath );
+    void LoadCompact( const fs::path& fsPath, const fs::path& fsParentPath, CompactTree& tree, CompactBuilder& builder );
+    template<typename Visitor>
+    void Visit( const fs::path& fsPath, const fs::path& fsParentPath, Visitor& visitor );
+    void LoadPipelined( const fs::path& fsPath, const fs::path& fsParentPath );
+    void LoadStaged( const fs::path& fsPath, const fs::path& fsParentPath, std::size_t id, Pipeline& pipeline );
+    void ReadStage( Pipeline& pipeline ) const;
+    void ParseStage( Pipeline& pipeline ) const;
+    std::optional<fs::path> Prepare( const fs::path&     fsPath,
+                                     const fs::path&     fsParentPath,
+                                     std::size_t&        graphNode,
+                                     IncludeGuard&       guard,
+                                     const ResolvedPath* preResolved = nullptr );
+    bool ReportErrors( const std::vector<ParseError>& errors, std::size_t graphNode );
+    void Loaded( std::size_t graphNode, std::uint64_t fileSize, Clock::duration parseDuration, std::uint64_t contributedNodes );
+    const ResolvedPath& Resolve( const fs::path& fsPath, const fs::path& fsParentPath );
+    void AddDependency( const ResolvedPath& resolved );
+    void AddDependencies( const std::vector<ResolvedPath>& resolved );
+    fs::path RootParent( const fs::path& fsPath ) const;
+
+    /// Shared cache, virtual paths are not shared
+    LoadCache* SharedCache() const { return fileSystem->IsDisk() ? cache : nullptr; }
+    void StartPrefetch();
+    void FinishPrefetch( std::uint64_t errorsBefore );
+    void Reader( const std::string& fname, bpt::ptree& pt );
+    LoadCache::FragmentPtr TryReader( const std::string& fname );
+    template<typename Handler>
+    void Parse( std::string_view text, const std::string& fname, Handler& handler, std::vector<ParseError>& errors,
+                std::vector<ResolvedPath>& directives ) const;
+    template<typename Handler>
+    static void ParseFormat( std::string_view text, const std::string& fname, Handler& handler, std::vector<ParseError>& errors,
+                             IncludeReader* includes );
+    static std::vector<std::string> ScanIncludes( std::string_view text );
+    std::shared_ptr<const CompactFragment> TryCompactReader( const std::string& fname );
+    void Fail( ParseError error );
+    void Writer( std::ostream& stream, const bpt::ptree& pt ) const;
+
+private:
+    /// Special key that represents include file
+    static constexpr const char* includeKey{ "IncludeFile" };
+
+    /// Include chains deeper than this are cut, loops are detected by includeChain
+    static constexpr const int depthLimit{ 20 };
+
+    bpt::ptree&        root;
+    std::stringstream  diagnostic;
+    int                depth;
+    LoadStats          stats;
+    TraceRecorder*     tracer{ nullptr };
+    LoadCache*         cache{ nullptr };
+    IncludeGraph*      graph{ nullptr };
+    PrefetchList*      prefetch{ nullptr };
+    const FileSystem*  fileSystem{ &diskFileSystem };
+    bool               retainSources{ false };
+    std::optional<Projection> projection;
+    bool               pipelined{ false };
+    bool               typedScalars{ false };
+    std::size_t        packMinSize{ 0 };
+
+    /// Graph node of the file whose includes are being loaded, and include position
+    static constexpr std::size_t noNode{ static_cast<std::size_t>( -1 ) };
+    std::size_t        graphParent{ noNode };
+    std::size_t        graphOrder{ 0 };
+
+    /// Set by TryLoad(), selects non-throwing readers and collects their errors
+    std::vector<ParseError>* errorSink{ nullptr };
+    ErrorPolicy              errorPolicy{ ErrorPolicy::discardFile };
+
+    /// Depfile inputs
+    std::vector<fs::path>           dependencies;
+    std::unordered_set<std::string> dependencySet;
+
+    /// Resolved paths of the files being loaded, root to current, to detect include loops
+    std::unordered_set<std::string> includeChain;
+
+    /// Resolved include paths, valid for the duration of one public Load()
+    std::unordered_map<std::string, ResolvedPath> pathCache;
+
+    /// Files read by the current public Load(), recorded if prefetch is attached
+    std::vector<fs::path>           accessOrder;
+    std::unordered_set<std::string> accessSet;
+
+    /// Memoized lookups on root
+    PathMemo memo;
+};
+
+// -----------------------------------------------------------------------------
+namespace detail
+{
+/// Number of nodes in a ptree, excluding the root itself
+inline std::uint64_t CountNodes( const bpt::ptree& pt )
+{
+    std::uint64_t count{ 0 };
+
+    for ( const auto& kv : pt )
+    {
+        count += 1 + CountNodes( kv.second );
+    }
+    return count;
+}
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// PtreeLoader definition
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::Load( const fs::path& fsPath )
+{
+    const auto start{ Clock::now() };
+    TraceScope trace( tracer, "Load", "load", fsPath.string() );
+
+    depth       = 0;
+    graphParent = noNode;
+    pathCache.clear();
+    memo.Invalidate();
+
+    const std::uint64_t errorsBefore{ stats.errors };
+    StartPrefetch();
+
+    if ( pipelined )
+    {
+        LoadPipelined( fsPath, RootParent( fsPath ) );
+    }
+    else
+    {
+        LoadFile( fsPath, RootParent( fsPath ) );
+    }
+    memo.Invalidate();
+    FinishPrefetch( errorsBefore );
+
+    stats.totalTime += Clock::now() - start;
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+LoadResult PtreeLoader<T>::TryLoad( const fs::path& fsPath, ErrorPolicy policy )
+{
+    std::vector<ParseError> errors;
+
+    errorSink   = &errors;
+    errorPolicy = policy;
+    Load( fsPath );
+    errorSink   = nullptr;
+
+    if ( errors.empty() )
+    {
+        return {};
+    }
+    return std::unexpected( std::move( errors ) );
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::Load( std::string_view text, const fs::path& fsPath )
+{
+    const fs::path          fsJoinedPath{ fsPath.is_absolute() ? fsPath : RootParent( fsPath ) / fsPath };
+    const FileSystem*       files{ fileSystem };
+    const OverlayFileSystem overlay( *files, files->Resolve( fsJoinedPath ).path, text );
+
+    fileSystem = &overlay;
+    Load( fsPath );
+    fileSystem = files;
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+LoadResult PtreeLoader<T>::TryLoad( std::string_view text, const fs::path& fsPath, ErrorPolicy policy )
+{
+    std::vector<ParseError> errors;
+
+    errorSink   = &errors;
+    errorPolicy = policy;
+    Load( text, fsPath );
+    errorSink   = nullptr;
+
+    if ( errors.empty() )
+    {
+        return {};
+    }
+    return std::unexpected( std::move( errors ) );
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+LoadResult PtreeLoader<T>::LoadCompact( const fs::path& fsPath, CompactTree& tree, ErrorPolicy policy )
+{
+    const auto start{ Clock::now() };
+    TraceScope trace( tracer, "LoadCompact", "load", fsPath.string() );
+
+    std::vector<ParseError> errors;
+
+    errorSink   = &errors;
+    errorPolicy = policy;
+    depth       = 0;
+    graphParent = noNode;
+    pathCache.clear();
+    tree.Clear();
+
+    const std::uint64_t errorsBefore{ stats.errors };
+    StartPrefetch();
+
+    CompactBuilder builder( tree );
+    LoadCompact( fsPath, RootParent( fsPath ), tree, builder );
+    builder.Finish();
+    FinishPrefetch( errorsBefore );
+
+    {
+        TraceScope traceIndex( tracer, "KeyIndex", "merge" );
+        const auto indexStart{ Clock::now() };
+        tree.BuildKeyIndex();
+        stats.mergeTime += Clock::now() - indexStart;
+    }
+
+    if ( typedScalars )
+    {
+        TraceScope traceConvert( tracer, "ConvertScalars", "merge" );
+        const auto convertStart{ Clock::now() };
+        tree.ConvertScalars();
+        stats.mergeTime += Clock::now() - convertStart;
+    }
+
+    errorSink        = nullptr;
+    stats.totalTime += Clock::now() - start;
+
+    if ( errors.empty() )
+    {
+        return {};
+    }
+    return std::unexpected( std::move( errors ) );
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+template<typename Visitor>
+LoadResult PtreeLoader<T>::Visit( const fs::path& fsPath, Visitor& visitor )
+{
+    const auto start{ Clock::now() };
+    TraceScope trace( tracer, "Visit", "load", fsPath.string() );
+
+    std::vector<ParseError> errors;
+
+    errorSink   = &errors;
+    errorPolicy = ErrorPolicy::keepPrefix;
+    depth       = 0;
+    graphParent = noNode;
+    pathCache.clear();
+
+    const std::uint64_t errorsBefore{ stats.errors };
+    StartPrefetch();
+
+    Visit( fsPath, RootParent( fsPath ), visitor );
+    FinishPrefetch( errorsBefore );
+
+    errorSink        = nullptr;
+    stats.totalTime += Clock::now() - start;
+
+    if ( errors.empty() )
+    {
+        return {};
+    }
+    return std::unexpected( std::move( errors ) );
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::Fail( ParseError error )
+{
+    ++stats.errors;
+
+    if ( errorSink )
+    {
+        errorSink->push_back( std::move( error ) );
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+auto PtreeLoader<T>::Resolve( const fs::path& fsPath, const fs::path& fsParentPath ) -> const ResolvedPath&
+{
+    const fs::path fsJoinedPath{ fsPath.is_absolute() ? fsPath : fsParentPath / fsPath };
+
+    const std::string key{ fsJoinedPath.string() };
+
+    if ( const auto it{ pathCache.find( key ) }; it != pathCache.end() )
+    {
+        ++stats.pathCacheHits;
+        return it->second;
+    }
+
+    LoadCache* sharedCache{ SharedCache() };
+
+    if ( sharedCache )
+    {
+        if ( auto resolved{ sharedCache->FindPath( key ) } )
+        {
+            ++stats.pathCacheHits;
+            return pathCache.emplace( key, std::move( *resolved ) ).first->second;
+        }
+    }
+
+    const auto start{ Clock::now() };
+    TraceScope trace( tracer, "Resolve", "resolve", fsJoinedPath.string() );
+
+    const ResolvedPath resolved{ fileSystem->Resolve( fsJoinedPath ) };
+
+    stats.resolveTime += Clock::now() - start;
+
+    if ( sharedCache )
+    {
+        sharedCache->StorePath( key, resolved );
+    }
+    return pathCache.emplace( key, resolved ).first->second;
+}
+
+// -----------------------------------------------------------------------------
+/// Directory a root path given to a public load is relative to
+template<PtreeFileFormat T>
+fs::path PtreeLoader<T>::RootParent( const fs::path& fsPath ) const
+{
+    return fsPath.is_relative() ? fileSystem->Root() : fs::path();
+}
+
+// -----------------------------------------------------------------------------
+/// Hint files of the previous load, start recording this one
+template<PtreeFileFormat T>
+void PtreeLoader<T>::StartPrefetch()
+{
+    accessOrder.clear();
+    accessSet.clear();
+
+    // Virtual file systems have nothing to prefetch
+    if ( prefetch && fileSystem->IsDisk() )
+    {
+        TraceScope trace( tracer, "Prefetch", "read" );
+        prefetch->Prefetch();
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Keep access order of a load without errors for the next start
+template<PtreeFileFormat T>
+void PtreeLoader<T>::FinishPrefetch( std::uint64_t errorsBefore )
+{
+    if ( prefetch && fileSystem->IsDisk() && stats.errors == errorsBefore )
+    {
+        prefetch->Assign( std::move( accessOrder ) );
+    }
+    accessOrder.clear();
+    accessSet.clear();
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::AddDependency( const ResolvedPath& resolved )
+{
+    fs::path fsDependency{ fileSystem->Dependency( resolved ) };
+
+    if ( !fsDependency.empty() && dependencySet.insert( fsDependency.string() ).second )
+    {
+        dependencies.push_back( std::move( fsDependency ) );
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::AddDependencies( const std::vector<ResolvedPath>& resolved )
+{
+    for ( const ResolvedPath& path : resolved )
+    {
+        AddDependency( path );
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+auto PtreeLoader<T>::Prepare( const fs::path&     fsPath,
+                              const fs::path&     fsParentPath,
+                              std::size_t&        graphNode,
+                              IncludeGuard&       guard,
+                              const ResolvedPath* preResolved ) -> std::optional<fs::path>
+{
+    if ( depth > depthLimit )
+    {
+        diagnostic << "Include depth limit exceeded. Exiting..." << '\n';
+        Fail( { fsPath.string(), 0, 0, "include depth limit exceeded" } );
+        return std::nullopt;
+    }
+
+    stats.maxIncludeDepth = std::max( stats.maxIncludeDepth, depth );
+
+    const ResolvedPath& resolved{ preResolved ? *preResolved : Resolve( fsPath, fsParentPath ) };
+    const fs::path      fsEffectivePath{ resolved.path };
+
+    graphNode = noNode;
+    AddDependency( resolved );
+
+    if ( graph )
+    {
+        graphNode = graph->AddNode( fsEffectivePath.string() );
+
+        IncludeGraph::Node& node{ graph->nodes[graphNode] };
+        node.exists = resolved.exists;
+        node.depth  = std::max( node.depth, depth );
+
+        if ( graphParent != noNode )
+        {
+            graph->AddEdge( graphParent, graphNode, graphOrder, fsPath.string() );
+        }
+    }
+
+    if ( !resolved.exists )
+    {
+        diagnostic << "Path not found: " << fsEffectivePath.string() << '\n';
+        Fail( { fsEffectivePath.string(), 0, 0, "path not found" } );
+        return std::nullopt;
+    }
+
+    if ( !includeChain.insert( fsEffectivePath.string() ).second )
+    {
+        diagnostic << "Recursive include loop detected: " << fsEffectivePath.string() << '\n';
+        Fail( { fsEffectivePath.string(), 0, 0, "recursive include loop detected" } );
+
+        if ( graph )
+        {
+            ++graph->nodes[graphNode].errors;
+        }
+        return std::nullopt;
+    }
+    guard.path = fsEffectivePath.string();
+
+    if ( prefetch && accessSet.insert( fsEffectivePath.string() ).second )
+    {
+        accessOrder.push_back( fsEffectivePath );
+    }
+
+    diagnostic << "Loading: " << fsEffectivePath.string() << '\n';
+    return fsEffectivePath;
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+bool PtreeLoader<T>::ReportErrors( const std::vector<ParseError>& errors, std::size_t graphNode )
+{
+    if ( errors.empty() )
+    {
+        return true;
+    }
+
+    for ( const auto& error : errors )
+    {
+        diagnostic << "Error: " << error.ToString() << '\n';
+
+        if ( errorSink )
+        {
+            errorSink->push_back( error );
+        }
+    }
+    stats.errors += errors.size();
+
+    if ( graph )
+    {
+        graph->nodes[graphNode].errors += errors.size();
+    }
+    return errorSink && errorPolicy == ErrorPolicy::keepPrefix;
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::Loaded( std::size_t     graphNode,
+                             std::uint64_t   fileSize,
+                             Clock::duration parseDuration,
+                             std::uint64_t   contributedNodes )
+{
+    ++stats.filesLoaded;
+    stats.bytesRead += fileSize;
+    stats.parseTime += parseDuration;
+
+    if ( graph )
+    {
+        IncludeGraph::Node& node{ graph->nodes[graphNode] };
+        node.size             = fileSize;
+        node.parseTime       += parseDuration;
+        node.contributedNodes = contributedNodes;
+        ++node.loads;
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::LoadFile( const fs::path& fsPath, const fs::path& fsParentPath )
+{
+    IncludeGuard includeGuard( *this );
+    std::size_t  graphNode;
+
+    const auto fsResolved{ Prepare( fsPath, fsParentPath, graphNode, includeGuard ) };
+
+    if ( !fsResolved )
+    {
+        return;
+    }
+
+    const fs::path& fsEffectivePath{ *fsResolved };
+
+    TraceScope traceFile( tracer, "LoadFile", "load", fsEffectivePath.string() );
+
+    // Temporary ptree to load current config
+    bpt::ptree             localSubtree;
+    LoadCache::FragmentPtr fragment;
+    std::uint64_t          fileSize{ 0 };
+    Clock::duration        parseDuration{};
+
+    if ( errorSink || projection || !fileSystem->IsDisk() )
+    {
+        // Projected fragments are not shared
+        LoadCache* fragmentCache{ projection ? nullptr : SharedCache() };
+
+        const std::string key{ std::to_string( static_cast<int>( T ) ) + ':' + fsEffectivePath.string() };
+
+        if ( fragmentCache && ( fragment = fragmentCache->FindFragment( key ) ) )
+        {
+            ++stats.fragmentCacheHits;
+        }
+        else
+        {
+            const auto start{ Clock::now() };
+            TraceScope trace( tracer, "Reader", "parse", fsEffectivePath.string() );
+
+            fragment = TryReader( fsEffectivePath.string() );
+            parseDuration = Clock::now() - start;
+
+            if ( fragmentCache )
+            {
+                fragment = fragmentCache->StoreFragment( key, std::move( fragment ) );
+            }
+        }
+
+        fileSize = fragment->size;
+        AddDependencies( fragment->directives );
+
+        if ( !ReportErrors( fragment->errors, graphNode ) )
+        {
+            return;
+        }
+    }
+    else
+    {
+        try
+        {
+            const auto start{ Clock::now() };
+            TraceScope trace( tracer, "Reader", "parse", fsEffectivePath.string() );
+            Reader( fsEffectivePath.string(), localSubtree );
+            parseDuration = Clock::now() - start;
+        }
+        catch ( const std::exception& e )
+        {
+            diagnostic << "Error: " << e.what() << '\n';
+            ++stats.errors;
+
+            if ( graph )
+            {
+                ++graph->nodes[graphNode].errors;
+            }
+            return;
+        }
+
+        std::error_code ec;
+        fileSize = fs::file_size( fsEffectivePath, ec );
+        fileSize = ec ? 0 : fileSize;
+    }
+
+    const bpt::ptree& subtree{ fragment ? fragment->tree : localSubtree };
+
+    Loaded( graphNode, fileSize, parseDuration,
+            std::ranges::count_if( subtree, []( const auto& kv ) { return kv.first != includeKey; } ) );
+
+    // Merge children from subtree into root tree at ptPath
+    TraceScope  traceMerge( tracer, "Merge", "merge", fsEffectivePath.string() );
+    auto        mergeStart{ Clock::now() };
+    std::size_t includeOrder{ 0 };
+
+    for ( const auto& kv : subtree )
+    {
+        // Add duplicate keys, don't replace.
+        root.add_child( kv.first, kv.second );
+        stats.nodesCreated += 1 + detail::CountNodes( kv.second );
+
+        if ( kv.first == includeKey )
+        {
+            // Handle IncludeFile, its own phases are accounted separately
+            stats.mergeTime += Clock::now() - mergeStart;
+            graphParent = graphNode;
+            graphOrder  = ++includeOrder;
+            LoadFile( kv.second.data(), fsEffectivePath.parent_path() );
+            mergeStart = Clock::now();
+        }
+    }
+
+    stats.mergeTime += Clock::now() - mergeStart;
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::LoadPipelined( const fs::path& fsPath, const fs::path& fsParentPath )
+{
+    Pipeline pipeline;
+
+    pipeline.Enqueue( { 0, fsPath, fsParentPath, 1, nullptr } );
+
+    std::jthread readThread( [&]() { ReadStage( pipeline ); } );
+    std::jthread parseThread( [&]() { ParseStage( pipeline ); } );
+
+    // Stages are stopped before the threads are joined, also if merging throws
+    struct Stopper
+    {
+        Pipeline& pipeline;
+        ~Stopper() { pipeline.Stop(); }
+    } stopper{ pipeline };
+
+    LoadStaged( fsPath, fsParentPath, 0, pipeline );
+}
+
+// -----------------------------------------------------------------------------
+/// Resolve and read requested files, until the stop request
+template<PtreeFileFormat T>
+void PtreeLoader<T>::ReadStage( Pipeline& pipeline ) const
+{
+    while ( true )
+    {
+        const Pipeline::Request request{ pipeline.NextRequest() };
+        Pipeline::Read          read;
+
+        read.id    = request.id;
+        read.depth = request.depth;
+
+        if ( request.id == Pipeline::noRequest )
+        {
+            pipeline.read.Push( std::move( read ) );
+            return;
+        }
+
+        TraceScope     trace( tracer, "Read", "read", request.path.string() );
+        const fs::path fsJoinedPath{ request.path.is_absolute() ? request.path : request.parentDir / request.path };
+        const auto     resolveStart{ Clock::now() };
+
+        LoadCache*     sharedCache{ SharedCache() };
+
+        if ( auto resolved{ sharedCache ? sharedCache->FindPath( fsJoinedPath.string() ) : std::nullopt } )
+        {
+            read.resolved     = std::move( *resolved );
+            read.pathCacheHit = true;
+        }
+        else
+        {
+            read.resolved = fileSystem->Resolve( fsJoinedPath );
+
+            if ( sharedCache )
+            {
+                sharedCache->StorePath( fsJoinedPath.string(), read.resolved );
+            }
+        }
+
+        const auto readStart{ Clock::now() };
+        read.resolveTime = readStart - resolveStart;
+
+        std::optional<std::string_view> text;
+
+        // A loop is reported by the merge stage, the file is neither read nor scanned
+        read.looped = read.resolved.exists && Pipeline::Chain::Contains( request.chain.get(), read.resolved.path );
+        read.chain  = std::make_shared<const Pipeline::Chain>( read.resolved.path, request.chain );
+
+        if ( read.resolved.exists && !read.looped )
+        {
+            text        = fileSystem->Read( read.resolved.path, read.content );
+            read.failed = !text;
+
+            // Content viewed in place, a view into read.content would not survive the move
+            if ( text && text->data() != read.content.data() )
+            {
+                read.view = *text;
+            }
+        }
+        read.readTime = Clock::now() - readStart;
+
+        // Includes found by the pre-scan are read before the file is parsed
+        if ( text && read.depth < depthLimit )
+        {
+            for ( std::string& path : ScanIncludes( *text ) )
+            {
+                const std::size_t id{ pipeline.nextId++ };
+                pipeline.Enqueue( { id, path, read.resolved.path.parent_path(), read.depth + 1, read.chain } );
+                read.scanned.push_back( { id, std::move( path ) } );
+            }
+        }
+
+        pipeline.read.Push( std::move( read ) );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Parse read files and request their includes, until the stop request
+template<PtreeFileFormat T>
+void PtreeLoader<T>::ParseStage( Pipeline& pipeline ) const
+{
+    while ( true )
+    {
+        Pipeline::Read   read{ pipeline.read.Pop() };
+        Pipeline::Result result;
+
+        result.id = read.id;
+
+        if ( read.id == Pipeline::noRequest )
+        {
+            pipeline.parsed.Push( std::move( result ) );
+            return;
+        }
+
+        result.resolved     = std::move( read.resolved );
+        result.resolveTime  = read.resolveTime;
+        result.pathCacheHit = read.pathCacheHit;
+
+        if ( !result.resolved.exists || read.looped )
+        {
+            pipeline.parsed.Push( std::move( result ) );
+            continue;
+        }
+
+        const std::string fname{ result.resolved.path.string() };
+        const std::string key{ std::to_string( static_cast<int>( T ) ) + ':' + fname };
+        const auto        start{ Clock::now() };
+
+        // Projected fragments are not shared
+        LoadCache* fragmentCache{ projection ? nullptr : SharedCache() };
+
+        if ( fragmentCache && ( result.fragment = fragmentCache->FindFragment( key ) ) )
+        {
+            result.fragmentCacheHit = true;
+        }
+        else
+        {
+            TraceScope trace( tracer, "Reader", "parse", fname );
+            auto       fragment{ std::make_shared<Fragment>() };
+
+            if ( read.failed )
+            {
+                fragment->errors.push_back( { fname, 0, 0, "cannot open file" } );
+            }
+            else
+            {
+                PtreeBuilder builder( fragment->tree );
+                const std::string_view text{ read.view.empty() ? std::string_view( read.content ) : read.view };
+
+                fragment->size = text.size();
+                Parse( text, fname, builder, fragment->errors, fragment->directives );
+            }
+
+            result.fragment = fragmentCache ? fragmentCache->StoreFragment( key, std::move( fragment ) )
+                                            : std::move( fragment );
+        }
+
+        result.parseTime = read.readTime + ( Clock::now() - start );
+
+        // Request includes the merge stage will follow, see LoadStaged()
+        const bool merged{ result.fragment->errors.empty() || ( errorSink && errorPolicy == ErrorPolicy::keepPrefix ) };
+
+        if ( merged && read.depth < depthLimit )
+        {
+            auto scanned{ read.scanned.begin() };
+
+            for ( const auto& kv : result.fragment->tree )
+            {
+                if ( kv.first != includeKey )
+                {
+                    continue;
+                }
+
+                // Pre-scanned includes are matched in order, unmatched ones are skipped
+                const auto match{ std::ranges::find( scanned, read.scanned.end(), kv.second.data(), &Pipeline::Scanned::path ) };
+
+                if ( match != read.scanned.end() )
+                {
+                    result.includes.push_back( match->id );
+                    scanned = match + 1;
+                    continue;
+                }
+
+                const std::size_t id{ pipeline.nextId++ };
+                result.includes.push_back( id );
+                pipeline.Enqueue( { id, kv.second.data(), result.resolved.path.parent_path(), read.depth + 1, read.chain } );
+            }
+        }
+
+        pipeline.parsed.Push( std::move( result ) );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Merge stage, same as LoadFile() with files read and parsed by the other stages
+template<PtreeFileFormat T>
+void PtreeLoader<T>::LoadStaged( const fs::path&  fsPath,
+                                 const fs::path&  fsParentPath,
+                                 std::size_t      id,
+                                 Pipeline&        pipeline )
+{
+    IncludeGuard includeGuard( *this );
+    std::size_t  graphNode;
+
+    // Includes beyond the depth limit are not requested and looped ones are not read, Prepare() rejects both
+    Pipeline::Result result;
+
+    if ( id != Pipeline::noRequest )
+    {
+        result = pipeline.Await( id );
+        stats.resolveTime   += result.resolveTime;
+        stats.pathCacheHits += result.pathCacheHit;
+    }
+
+    const auto fsResolved{ Prepare( fsPath, fsParentPath, graphNode, includeGuard, id != Pipeline::noRequest ? &result.resolved : nullptr ) };
+
+    if ( !fsResolved )
+    {
+        return;
+    }
+
+    const fs::path& fsEffectivePath{ *fsResolved };
+
+    TraceScope traceFile( tracer, "LoadFile", "load", fsEffectivePath.string() );
+
+    const LoadCache::FragmentPtr fragment{ std::move( result.fragment ) };
+
+    stats.fragmentCacheHits += result.fragmentCacheHit;
+    AddDependencies( fragment->directives );
+
+    if ( !ReportErrors( fragment->errors, graphNode ) )
+    {
+        return;
+    }
+
+    Loaded( graphNode, fragment->size, result.parseTime,
+            std::ranges::count_if( fragment->tree, []( const auto& kv ) { return kv.first != includeKey; } ) );
+
+    TraceScope  traceMerge( tracer, "Merge", "merge", fsEffectivePath.string() );
+    auto        mergeStart{ Clock::now() };
+    std::size_t includeOrder{ 0 };
+
+    for ( const auto& kv : fragment->tree )
+    {
+        // Add duplicate keys, don't replace.
+        root.add_child( kv.first, kv.second );
+        stats.nodesCreated += 1 + detail::CountNodes( kv.second );
+
+        if ( kv.first == includeKey )
+        {
+            stats.mergeTime += Clock::now() - mergeStart;
+            graphParent = graphNode;
+            graphOrder  = ++includeOrder;
+            LoadStaged( kv.second.data(), fsEffectivePath.parent_path(),
+                        includeOrder <= result.includes.size() ? result.includes[includeOrder - 1] : Pipeline::noRequest,
+                        pipeline );
+            mergeStart = Clock::now();
+        }
+    }
+
+    stats.mergeTime += Clock::now() - mergeStart;
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::LoadCompact( const fs::path& fsPath,
+                                  const fs::path& fsParentPath,
+                                  CompactTree&    tree,
+                                  CompactBuilder& builder )
+{
+    IncludeGuard includeGuard( *this );
+    std::size_t  graphNode;
+
+    const auto fsResolved{ Prepare( fsPath, fsParentPath, graphNode, includeGuard ) };
+
+    if ( !fsResolved )
+    {
+        return;
+    }
+
+    const fs::path& fsEffectivePath{ *fsResolved };
+
+    TraceScope traceFile( tracer, "LoadFile", "load", fsEffectivePath.string() );
+
+    const auto start{ Clock::now() };
+    std::shared_ptr<const CompactFragment> fragment;
+    {
+        TraceScope trace( tracer, "Reader", "parse", fsEffectivePath.string() );
+        fragment = TryCompactReader( fsEffectivePath.string() );
+    }
+    const Clock::duration parseDuration{ Clock::now() - start };
+
+    AddDependencies( fragment->directives );
+
+    if ( !ReportErrors( fragment->errors, graphNode ) )
+    {
+        return;
+    }
+
+    const CompactNode subtree{ fragment->tree.Root() };
+    std::uint64_t     contributedNodes{ 0 };
+
+    for ( const CompactNode node : subtree )
+    {
+        contributedNodes += node.Key() != includeKey;
+    }
+
+    Loaded( graphNode, fragment->size, parseDuration, contributedNodes );
+
+    // Strings of the fragment are shared, not copied
+    builder.Retain( fragment->strings );
+
+    TraceScope  traceMerge( tracer, "Merge", "merge", fsEffectivePath.string() );
+    auto        mergeStart{ Clock::now() };
+    std::size_t includeOrder{ 0 };
+
+    for ( const CompactNode node : subtree )
+    {
+        const std::size_t nodeCount{ tree.NodeCount() };
+
+        builder.AppendCopy( node );
+        stats.nodesCreated += 1 + tree.NodeCount() - nodeCount;
+
+        if ( node.Key() == includeKey )
+        {
+            stats.mergeTime += Clock::now() - mergeStart;
+            graphParent = graphNode;
+            graphOrder  = ++includeOrder;
+            LoadCompact( node.Data(), fsEffectivePath.parent_path(), tree, builder );
+            mergeStart = Clock::now();
+        }
+    }
+
+    stats.mergeTime += Clock::now() - mergeStart;
+}
+
+// -----------------------------------------------------------------------------
+// Forwards events to the visitor and streams each top-level include right after
+// its key, or after the key's subtree if it has one.
+template<PtreeFileFormat T>
+template<typename Visitor>
+class PtreeLoader<T>::IncludeFollower
+{
+public:
+    IncludeFollower( PtreeLoader& loader, Visitor& visitor, const fs::path& fsDir, std::size_t graphNode )
+        : loader( loader ), visitor( visitor ), fsDir( fsDir ), graphNode( graphNode ) {}
+
+    bool Key( std::string_view key )
+    {
+        if ( level == 0 )
+        {
+            Follow();
+            isInclude         = key == includeKey;
+            contributedNodes += !isInclude;
+        }
+        return detail::AcceptKey( visitor, key );
+    }
+
+    void Value( std::string_view value )
+    {
+        if ( level == 0 && isInclude )
+        {
+            pending = value;
+        }
+        visitor.Value( value );
+    }
+
+    void Enter() { ++level; visitor.Enter(); }
+    void Leave() { --level; visitor.Leave(); }
+    void BeginInclude() { detail::BeginInclude( visitor ); }
+    void EndInclude()   { detail::EndInclude( visitor ); }
+
+    /// Stream pending include
+    void Follow()
+    {
+        if ( !pending )
+        {
+            return;
+        }
+
+        const auto start{ Clock::now() };
+
+        loader.graphParent = graphNode;
+        loader.graphOrder  = ++includeOrder;
+        loader.Visit( fs::path( *pending ), fsDir, visitor );
+        pending.reset();
+
+        nestedTime += Clock::now() - start;
+    }
+
+    std::uint64_t   contributedNodes{ 0 };
+    Clock::duration nestedTime{};
+
+private:
+    PtreeLoader&               loader;
+    Visitor&                   visitor;
+    const fs::path&            fsDir;
+    const std::size_t          graphNode;
+    std::size_t                level{ 0 };
+    std::size_t                includeOrder{ 0 };
+    bool                       isInclude{ false };
+    std::optional<std::string> pending;
+};
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+template<typename Visitor>
+void PtreeLoader<T>::Visit( const fs::path& fsPath, const fs::path& fsParentPath, Visitor& visitor )
+{
+    IncludeGuard includeGuard( *this );
+    std::size_t  graphNode;
+
+    const auto fsResolved{ Prepare( fsPath, fsParentPath, graphNode, includeGuard ) };
+
+    if ( !fsResolved )
+    {
+        return;
+    }
+
+    const fs::path& fsEffectivePath{ *fsResolved };
+    const fs::path  fsDir{ fsEffectivePath.parent_path() };
+
+    TraceScope traceFile( tracer, "LoadFile", "load", fsEffectivePath.string() );
+
+    std::string               content;
+    std::vector<ParseError>   errors;
+    std::vector<ResolvedPath> directives;
+    const auto                text{ fileSystem->Read( fsEffectivePath, content ) };
+
+    if ( !text )
+    {
+        errors.push_back( { fsEffectivePath.string(), 0, 0, "cannot open file" } );
+        ReportErrors( errors, graphNode );
+        return;
+    }
+
+    visitor.Include( fsEffectivePath );
+
+    const auto                start{ Clock::now() };
+    IncludeFollower<Visitor>  follower( *this, visitor, fsDir, graphNode );
+
+    Parse( *text, fsEffectivePath.string(), follower, errors, directives );
+    follower.Follow();
+    AddDependencies( directives );
+
+    ReportErrors( errors, graphNode );
+    Loaded( graphNode, text->size(), Clock::now() - start - follower.nestedTime, follower.contributedNodes );
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::Reader( const std::string& fname, bpt::ptree& pt )
+{
+    FormatParser<T>::Read( fname, pt );
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+void PtreeLoader<T>::Writer( std::ostream& stream, const bpt::ptree& pt ) const
+{
+    FormatParser<T>::Write( stream, pt );
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+template<typename Handler>
+void PtreeLoader<T>::Parse( std::string_view               text,
+                            const std::string&             fname,
+                            Handler&                       handler,
+                            std::vector<ParseError>&       errors,
+                            std::vector<ResolvedPath>&     directives ) const
+{
+    DirectiveReader includes( *fileSystem, directives );
+
+    if ( projection )
+    {
+        ProjectionFilter<Handler> filter( *projection, handler );
+        ParseFormat( text, fname, filter, errors, &includes );
+    }
+    else
+    {
+        ParseFormat( text, fname, handler, errors, &includes );
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+std::vector<std::string> PtreeLoader<T>::ScanIncludes( std::string_view text )
+{
+    if constexpr ( T == PtreeFileFormat::info )
+    {
+        return ScanInfoIncludes( text, includeKey );
+    }
+    else if constexpr ( T == PtreeFileFormat::json )
+    {
+        return ScanJsonIncludes( text, includeKey );
+    }
+    else
+    {
+        return ScanXmlIncludes( text, includeKey );
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+template<typename Handler>
+void PtreeLoader<T>::ParseFormat( std::string_view           text,
+                                  const std::string&         fname,
+                                  Handler&                   handler,
+                                  std::vector<ParseError>&   errors,
+                                  IncludeReader*             includes )
+{
+    if constexpr ( T == PtreeFileFormat::info )
+    {
+        ParseInfo( text, fname, handler, errors, includes );
+    }
+    else if constexpr ( T == PtreeFileFormat::json )
+    {
+        ParseJson( text, fname, handler, errors );
+    }
+    else
+    {
+        // Boost XML parser builds a ptree
+        bpt::ptree pt;
+
+        if ( FormatParser<T>::Read( text, fname, pt, errors ) )
+        {
+            EmitPtree( pt, handler );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+LoadCache::FragmentPtr PtreeLoader<T>::TryReader( const std::string& fname )
+{
+    auto        fragment{ std::make_shared<Fragment>() };
+    std::string content;
+    const auto  text{ fileSystem->Read( fname, content ) };
+
+    if ( !text )
+    {
+        fragment->errors.push_back( { fname, 0, 0, "cannot open file" } );
+        return fragment;
+    }
+
+    fragment->size = text->size();
+
+    if constexpr ( T == PtreeFileFormat::xml )
+    {
+        // Boost XML parser builds the tree directly
+        if ( !projection )
+        {
+            FormatParser<T>::Read( *text, fname, fragment->tree, fragment->errors );
+            return fragment;
+        }
+    }
+
+    PtreeBuilder builder( fragment->tree );
+    Parse( *text, fname, builder, fragment->errors, fragment->directives );
+    return fragment;
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+auto PtreeLoader<T>::TryCompactReader( const std::string& fname ) -> std::shared_ptr<const CompactFragment>
+{
+    auto             fragment{ std::make_shared<CompactFragment>() };
+    std::string      content;
+    std::string_view text;
+    CompactBuilder   builder( fragment->tree );
+
+    builder.SetPackArrays( packMinSize );
+
+    if ( retainSources && T != PtreeFileFormat::xml && fileSystem->IsDisk() )
+    {
+        if ( !fragment->strings->source.Open( fname ) )
+        {
+            fragment->errors.push_back( { fname, 0, 0, "cannot open file" } );
+            return fragment;
+        }
+
+        text = fragment->strings->source.View();
+        builder.SetSource( text );
+    }
+    else
+    {
+        const auto read{ fileSystem->Read( fname, content ) };
+
+        if ( !read )
+        {
+            fragment->errors.push_back( { fname, 0, 0, "cannot open file" } );
+            return fragment;
+        }
+
+        text = *read;
+
+        // Content viewed in place outlives the tree, see SetFileSystem()
+        if ( retainSources && T != PtreeFileFormat::xml && text.data() != content.data() )
+        {
+            builder.SetSource( text );
+        }
+    }
+
+    fragment->size = text.size();
+
+    Parse( text, fname, builder, fragment->errors, fragment->directives );
+
+    builder.Finish();
+    fragment->strings->arena = builder.TakeArena();
+    return fragment;
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+bool PtreeLoader<T>::WriteDepfile( const fs::path& fsDepfile, const std::string& target ) const
+{
+    // Escape characters that are special in Makefile rules
+    auto escape = []( const std::string& str )
+    {
+        std::string result;
+
+        for ( const char c : str )
+        {
+            if ( c == ' ' || c == '#' )
+            {
+                result += '\\';
+            }
+            else if ( c == '$' )
+            {
+                result += '$';
+            }
+            result += c;
+        }
+        return result;
+    };
+
+    std::ofstream stream( fsDepfile, std::ios::binary );
+
+    stream << escape( target ) << ':';
+
+    for ( const auto& fsDependency : dependencies )
+    {
+        stream << " \\\n  " << escape( fsDependency.generic_string() );
+    }
+    stream << '\n';
+
+    return stream.good();
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+std::string PtreeLoader<T>::DumpDiag() const
+{
+    std::string delim( 80, '=' );
+
+    return delim + '\n' + diagnostic.str() + delim + '\n';
+}
+
+// -----------------------------------------------------------------------------
+template<PtreeFileFormat T>
+std::string PtreeLoader<T>::DumpPtree() const
+{
+    std::stringstream ss;
+    std::string delim( 80, '=' );
+
+    ss << delim << '\n';
+    Writer( ss, root );
+    ss << '\n' << delim << '\n';
+    return ss.str();
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeLoaderCore_H
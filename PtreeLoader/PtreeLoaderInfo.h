@@ -0,0 +1,55 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// PtreeLoader for INFO files, see PtreeLoaderCore.h.
+// Load() without a projection reads disk files with the Boost parser, other
+// loads use the native parser of PtreeParsers.h.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeLoaderInfo_H
+#define PtreeLoaderInfo_H
+
+// -----------------------------------------------------------------------------
+#include "PtreeLoaderCore.h"
+
+#if !defined( PTREE_LOADER_LIBRARY ) || defined( PTREE_LOADER_BUILD )
+#include <boost/property_tree/info_parser.hpp>
+#endif
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+template<>
+struct FormatParser<PtreeFileFormat::info>
+{
+    static void Read( const std::string& fname, bpt::ptree& pt );
+    static void Write( std::ostream& stream, const bpt::ptree& pt );
+};
+
+#ifdef PTREE_LOADER_LIBRARY
+extern template class PtreeLoader<PtreeFileFormat::info>;
+#endif
+
+// -----------------------------------------------------------------------------
+// FormatParser definition
+// -----------------------------------------------------------------------------
+#if !defined( PTREE_LOADER_LIBRARY ) || defined( PTREE_LOADER_BUILD )
+PTREE_LOADER_INLINE void FormatParser<PtreeFileFormat::info>::Read( const std::string& fname, bpt::ptree& pt )
+{
+    bpt::info_parser::read_info( fname, pt );
+}
+
+// -----------------------------------------------------------------------------
+PTREE_LOADER_INLINE void FormatParser<PtreeFileFormat::info>::Write( std::ostream& stream, const bpt::ptree& pt )
+{
+    bpt::info_parser::write_info( stream, pt );
+}
+#endif
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeLoaderInfo_H
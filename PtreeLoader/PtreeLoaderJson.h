@@ -0,0 +1,55 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// PtreeLoader for JSON files, see PtreeLoaderCore.h.
+// Load() without a projection reads disk files with the Boost parser, other
+// loads use the native parser of PtreeParsers.h.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeLoaderJson_H
+#define PtreeLoaderJson_H
+
+// -----------------------------------------------------------------------------
+#include "PtreeLoaderCore.h"
+
+#if !defined( PTREE_LOADER_LIBRARY ) || defined( PTREE_LOADER_BUILD )
+#include <boost/property_tree/json_parser.hpp>
+#endif
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+template<>
+struct FormatParser<PtreeFileFormat::json>
+{
+    static void Read( const std::string& fname, bpt::ptree& pt );
+    static void Write( std::ostream& stream, const bpt::ptree& pt );
+};
+
+#ifdef PTREE_LOADER_LIBRARY
+extern template class PtreeLoader<PtreeFileFormat::json>;
+#endif
+
+// -----------------------------------------------------------------------------
+// FormatParser definition
+// -----------------------------------------------------------------------------
+#if !defined( PTREE_LOADER_LIBRARY ) || defined( PTREE_LOADER_BUILD )
+PTREE_LOADER_INLINE void FormatParser<PtreeFileFormat::json>::Read( const std::string& fname, bpt::ptree& pt )
+{
+    bpt::json_parser::read_json( fname, pt );
+}
+
+// -----------------------------------------------------------------------------
+PTREE_LOADER_INLINE void FormatParser<PtreeFileFormat::json>::Write( std::ostream& stream, const bpt::ptree& pt )
+{
+    bpt::json_parser::write_json( stream, pt );
+}
+#endif
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeLoaderJson_H
@@ -0,0 +1,77 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// PtreeLoader for XML files, see PtreeLoaderCore.h.
+// XML is parsed by Boost only, with and without TryLoad().
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeLoaderXml_H
+#define PtreeLoaderXml_H
+
+// -----------------------------------------------------------------------------
+#include "PtreeLoaderCore.h"
+
+#if !defined( PTREE_LOADER_LIBRARY ) || defined( PTREE_LOADER_BUILD )
+#include <boost/property_tree/xml_parser.hpp>
+#endif
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+template<>
+struct FormatParser<PtreeFileFormat::xml>
+{
+    static void Read( const std::string& fname, bpt::ptree& pt );
+    static bool Read( std::string_view text, const std::string& fname, bpt::ptree& pt, std::vector<ParseError>& errors );
+    static void Write( std::ostream& stream, const bpt::ptree& pt );
+};
+
+#ifdef PTREE_LOADER_LIBRARY
+extern template class PtreeLoader<PtreeFileFormat::xml>;
+#endif
+
+// -----------------------------------------------------------------------------
+// FormatParser definition
+// -----------------------------------------------------------------------------
+#if !defined( PTREE_LOADER_LIBRARY ) || defined( PTREE_LOADER_BUILD )
+PTREE_LOADER_INLINE void FormatParser<PtreeFileFormat::xml>::Read( const std::string& fname, bpt::ptree& pt )
+{
+    bpt::xml_parser::read_xml( fname, pt );
+}
+
+// -----------------------------------------------------------------------------
+/// Boost XML parser reports errors by throwing only
+PTREE_LOADER_INLINE bool FormatParser<PtreeFileFormat::xml>::Read( std::string_view         text,
+                                                                   const std::string&       fname,
+                                                                   bpt::ptree&              pt,
+                                                                   std::vector<ParseError>& errors )
+{
+    try
+    {
+        detail::ViewStreambuf buffer( text );
+        std::istream          stream( &buffer );
+        bpt::xml_parser::read_xml( stream, pt, 0 );
+        return true;
+    }
+    catch ( const bpt::xml_parser_error& e )
+    {
+        // Errors of a stream carry no file name
+        errors.push_back( { fname, e.line(), 0, e.message() } );
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+PTREE_LOADER_INLINE void FormatParser<PtreeFileFormat::xml>::Write( std::ostream& stream, const bpt::ptree& pt )
+{
+    bpt::xml_parser::write_xml( stream, pt );
+}
+#endif
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeLoaderXml_H
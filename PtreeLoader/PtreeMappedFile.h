@@ -0,0 +1,171 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Read-only memory mapped file (POSIX mmap / Win32 file mapping).
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeMappedFile_H
+#define PtreeMappedFile_H
+
+// -----------------------------------------------------------------------------
+#include <string_view>
+#include <filesystem>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+// MappedFile
+// -----------------------------------------------------------------------------
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile( const MappedFile& )             = delete;
+    MappedFile& operator=( const MappedFile& )  = delete;
+    MappedFile( MappedFile&& other ) noexcept   { Swap( other ); }
+    MappedFile& operator=( MappedFile&& other ) noexcept { MappedFile( std::move( other ) ).Swap( *this ); return *this; }
+    ~MappedFile()                               { Close(); }
+
+    /// Map whole file read-only
+    /// @return false if the file could not be opened or mapped
+    bool Open( const std::filesystem::path& fsPath );
+
+    /// Unmap file
+    void Close();
+
+    bool             IsOpen() const { return open; }
+    std::string_view View() const   { return { data, size }; }
+
+private:
+    void Swap( MappedFile& other ) noexcept
+    {
+        std::swap( data, other.data );
+        std::swap( size, other.size );
+        std::swap( open, other.open );
+    }
+
+    const char* data{ nullptr };
+    std::size_t size{ 0 };
+    bool        open{ false }; ///< Empty files are open without a mapping
+};
+
+// -----------------------------------------------------------------------------
+// MappedFile definition
+// -----------------------------------------------------------------------------
+inline bool MappedFile::Open( const std::filesystem::path& fsPath )
+{
+    Close();
+
+#ifdef _WIN32
+    const HANDLE file{ CreateFileW( fsPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr ) };
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if ( !GetFileSizeEx( file, &fileSize ) )
+    {
+        CloseHandle( file );
+        return false;
+    }
+
+    if ( fileSize.QuadPart == 0 )
+    {
+        CloseHandle( file );
+        open = true;
+        return true;
+    }
+
+    const HANDLE mapping{ CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr ) };
+    CloseHandle( file );
+
+    if ( !mapping )
+    {
+        return false;
+    }
+
+    const void* view{ MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) };
+    CloseHandle( mapping );
+
+    if ( !view )
+    {
+        return false;
+    }
+
+    data = static_cast<const char*>( view );
+    size = static_cast<std::size_t>( fileSize.QuadPart );
+#else
+    const int fd{ ::open( fsPath.c_str(), O_RDONLY | O_CLOEXEC ) };
+    if ( fd < 0 )
+    {
+        return false;
+    }
+
+    struct stat st;
+    if ( ::fstat( fd, &st ) != 0 )
+    {
+        ::close( fd );
+        return false;
+    }
+
+    if ( st.st_size == 0 )
+    {
+        ::close( fd );
+        open = true;
+        return true;
+    }
+
+    void* view{ ::mmap( nullptr, static_cast<std::size_t>( st.st_size ), PROT_READ, MAP_SHARED, fd, 0 ) };
+    ::close( fd );
+
+    if ( view == MAP_FAILED )
+    {
+        return false;
+    }
+
+    data = static_cast<const char*>( view );
+    size = static_cast<std::size_t>( st.st_size );
+#endif
+    open = true;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+inline void MappedFile::Close()
+{
+    if ( data )
+    {
+#ifdef _WIN32
+        UnmapViewOfFile( data );
+#else
+        ::munmap( const_cast<char*>( data ), size );
+#endif
+    }
+
+    data = nullptr;
+    size = 0;
+    open = false;
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeMappedFile_H
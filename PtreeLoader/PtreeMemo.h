@@ -0,0 +1,82 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Memoized path lookups on a ptree.
+// The first lookup of a dotted path walks the tree, repeated lookups are a
+// single hash probe. Safe for concurrent readers. The memo holds pointers to
+// nodes, so it has to be invalidated whenever the tree is modified.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeMemo_H
+#define PtreeMemo_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <functional>
+#include <boost/property_tree/ptree.hpp>
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+namespace bpt = boost::property_tree;
+
+// -----------------------------------------------------------------------------
+// PathMemo
+// -----------------------------------------------------------------------------
+class PathMemo
+{
+public:
+    /// @param root ptree to look up in
+    explicit PathMemo( const bpt::ptree& root ) : root( root ) {}
+    PathMemo( const PathMemo& )             = delete;
+    PathMemo& operator=( const PathMemo& )  = delete;
+
+    /// Find node by dotted path, same semantics as ptree::get_child_optional()
+    /// @return Node or nullptr if there is no such path
+    const bpt::ptree* Find( std::string_view path ) const
+    {
+        {
+            std::shared_lock lock( mutex );
+
+            if ( const auto it{ memo.find( path ) }; it != memo.end() )
+            {
+                return it->second;
+            }
+        }
+
+        const auto        child{ root.get_child_optional( bpt::ptree::path_type( std::string( path ) ) ) };
+        const bpt::ptree* node{ child ? &*child : nullptr };
+
+        std::unique_lock lock( mutex );
+        memo.emplace( path, node );
+        return node;
+    }
+
+    /// Forget all memoized paths, required after the tree is modified
+    void Invalidate()
+    {
+        std::unique_lock lock( mutex );
+        memo.clear();
+    }
+
+private:
+    struct Hash
+    {
+        using is_transparent = void;
+        std::size_t operator()( std::string_view str ) const { return std::hash<std::string_view>{}( str ); }
+    };
+
+    const bpt::ptree&                                                                root;
+    mutable std::shared_mutex                                                        mutex;
+    mutable std::unordered_map<std::string, const bpt::ptree*, Hash, std::equal_to<>> memo;
+};
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeMemo_H
@@ -0,0 +1,1302 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Non-throwing parsers for INFO and JSON formats.
+// Both parsers work on an in-memory buffer and report parsed content as events
+// to a handler, so the same parser can build a ptree or feed other consumers.
+// Errors are collected with their location instead of being thrown.
+// For valid input the resulting ptree is identical to read_info()/read_json().
+//
+// Handler requirements:
+//   void Key( std::string_view key );     // new child of the current node,
+//                                         // may return bool, false skips the
+//                                         // value and subtree of the key
+//   void Value( std::string_view value ); // data of the last child, or of the
+//                                         // current node if there is none
+//   void Enter();                         // descend into the last child
+//   void Leave();                         // return to the parent node
+//   void BeginInclude();                  // optional, children of an INFO
+//   void EndInclude();                    // #include follow, the last child
+//                                         // before them stays the last child
+// Views passed to the handler are valid only for the duration of the call.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeParsers_H
+#define PtreeParsers_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <boost/property_tree/ptree.hpp>
+#include "PtreeUtils.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+namespace bpt = boost::property_tree;
+
+// -----------------------------------------------------------------------------
+// ParseError
+// -----------------------------------------------------------------------------
+struct ParseError
+{
+    std::string file;
+    std::size_t line{ 0 };    ///< 1-based, 0 if unknown
+    std::size_t column{ 0 };  ///< 1-based, 0 if unknown
+    std::string message;
+
+    /// Format as "file(line,column): message"
+    std::string ToString() const
+    {
+        std::stringstream ss;
+
+        ss << file;
+        if ( line )
+        {
+            ss << '(' << line;
+            if ( column )
+            {
+                ss << ',' << column;
+            }
+            ss << ')';
+        }
+        ss << ": " << message;
+        return ss.str();
+    }
+};
+
+// -----------------------------------------------------------------------------
+// IncludeReader : source of the files of INFO #include directives
+// -----------------------------------------------------------------------------
+class IncludeReader
+{
+public:
+    virtual ~IncludeReader() = default;
+
+    /// Content of the included file
+    /// @param name File name as written in the directive
+    /// @param storage Receives the content unless it can be viewed in place
+    /// @param fname Receives the file name for errors and nested directives
+    /// @return Nothing if the file cannot be read
+    virtual std::optional<std::string_view> Read( std::string_view name, std::string& storage, std::string& fname ) = 0;
+};
+
+// -----------------------------------------------------------------------------
+// PtreeBuilder : handler that builds a ptree
+// -----------------------------------------------------------------------------
+class PtreeBuilder
+{
+public:
+    explicit PtreeBuilder( bpt::ptree& root ) : stack{ &root } {}
+
+    void Key( std::string_view key )
+    {
+        last = &stack.back()->push_back( { std::string( key ), bpt::ptree() } )->second;
+    }
+
+    void Value( std::string_view value )
+    {
+        ( last ? last : stack.back() )->data().assign( value );
+    }
+
+    void Enter()
+    {
+        stack.push_back( last ? last : stack.back() );
+        last = nullptr;
+    }
+
+    void Leave()
+    {
+        stack.pop_back();
+        last = nullptr;
+    }
+
+    void BeginInclude() { included.push_back( last ); }
+
+    void EndInclude()
+    {
+        last = included.back();
+        included.pop_back();
+    }
+
+private:
+    std::vector<bpt::ptree*> stack;
+    bpt::ptree*              last{ nullptr };
+    std::vector<bpt::ptree*> included;  ///< Last child before each include
+};
+
+// -----------------------------------------------------------------------------
+namespace detail
+{
+
+// -----------------------------------------------------------------------------
+inline bool IsAsciiSpace( char c )
+{
+    const auto n{ static_cast<unsigned char>( c ) };
+    return n <= 127 && std::isspace( n );
+}
+
+// -----------------------------------------------------------------------------
+/// Handler that ignores all events
+struct NullHandler
+{
+    void Key( std::string_view ) {}
+    void Value( std::string_view ) {}
+    void Enter() {}
+    void Leave() {}
+};
+
+// -----------------------------------------------------------------------------
+/// Read whole file into a string
+/// @return false if the file could not be read
+inline bool ReadFile( const std::string& fname, std::string& content )
+{
+    std::ifstream stream( fname, std::ios::binary );
+
+    if ( !stream )
+    {
+        return false;
+    }
+
+    stream.seekg( 0, std::ios::end );
+    const auto size{ stream.tellg() };
+    stream.seekg( 0, std::ios::beg );
+
+    content.resize( size > 0 ? static_cast<std::size_t>( size ) : 0 );
+    stream.read( content.data(), static_cast<std::streamsize>( content.size() ) );
+    return !stream.bad();
+}
+
+// -----------------------------------------------------------------------------
+// InfoParser
+// -----------------------------------------------------------------------------
+template<typename Handler>
+class InfoParser
+{
+public:
+    InfoParser( Handler& handler, const std::string& fname, std::vector<ParseError>& errors, int includeDepth,
+                IncludeReader* includes )
+        : handler( handler ), fname( fname ), errors( errors ), includeDepth( includeDepth ), includes( includes ) {}
+
+    /// @return true if no errors were found
+    bool Parse( std::string_view text );
+
+private:
+    enum class State
+    {
+        key,      // Parser expects key
+        data,     // Parser expects data
+        dataCont  // Parser expects data continuation
+    };
+
+    void Error( const char* message, const char* pos );
+    void SkipSpace();
+    bool AtLineEnd() const { return p == e || *p == ';'; }
+    bool Expand( const char* b, const char* end, std::string_view& out );
+    bool ReadWord( std::string_view& out );
+    bool ReadString( std::string_view& out, bool* needMoreLines );
+    bool ReadKey( std::string_view& out );
+    bool ReadData( std::string_view& out, bool* needMoreLines );
+    bool Directive();
+    void Line();
+
+    // Forward events only until the first error, keeping the well-formed prefix,
+    // and not for the value and subtree of a key rejected by the handler
+    bool Forwarding() const { return errors.size() == firstError && !( rejected >= 0 && depth > rejected ); }
+    void EmitKey( std::string_view key );
+    void EmitValue( std::string_view value ) { if ( Forwarding() && rejected < 0 ) handler.Value( value ); }
+    void EmitEnter()                         { if ( Forwarding() && rejected < 0 ) handler.Enter(); }
+    void EmitLeave();
+
+    Handler&                  handler;
+    const std::string&        fname;
+    std::vector<ParseError>&  errors;
+    const std::size_t         firstError{ errors.size() };
+    const int                 includeDepth;
+    IncludeReader*            includes;  // Null reads #include files from disk
+
+    State                     state{ State::key };
+    std::size_t               lineNo{ 0 };
+    const char*               lineStart{ nullptr };
+    const char*               p{ nullptr };
+    const char*               e{ nullptr };
+    int                       depth{ 0 };
+    int                       rejected{ -1 };  // Depth of the last key if rejected
+    bool                      haveLast{ false };
+    std::string               scratch;
+    std::string               pending;
+};
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+void InfoParser<Handler>::EmitKey( std::string_view key )
+{
+    if ( Forwarding() )
+    {
+        rejected = AcceptKey( handler, key ) ? -1 : depth;
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+void InfoParser<Handler>::EmitLeave()
+{
+    // Leaving the subtree of a rejected key is not forwarded
+    if ( Forwarding() )
+    {
+        rejected = -1;
+        handler.Leave();
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+void InfoParser<Handler>::Error( const char* message, const char* pos )
+{
+    errors.push_back( { fname, lineNo, static_cast<std::size_t>( pos - lineStart ) + 1, message } );
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+void InfoParser<Handler>::SkipSpace()
+{
+    while ( p != e && IsAsciiSpace( *p ) )
+    {
+        ++p;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Expand known escape sequences, copies only if there is any
+template<typename Handler>
+bool InfoParser<Handler>::Expand( const char* b, const char* end, std::string_view& out )
+{
+    const char* bs{ static_cast<const char*>( std::memchr( b, '\\', end - b ) ) };
+
+    if ( !bs )
+    {
+        out = std::string_view( b, end - b );
+        return true;
+    }
+
+    scratch.assign( b, bs );
+
+    for ( b = bs; b != end; ++b )
+    {
+        if ( *b != '\\' )
+        {
+            scratch += *b;
+            continue;
+        }
+
+        if ( ++b == end )
+        {
+            Error( "character expected after backslash", b );
+            return false;
+        }
+
+        switch ( *b )
+        {
+            case '0':  scratch += '\0'; break;
+            case 'a':  scratch += '\a'; break;
+            case 'b':  scratch += '\b'; break;
+            case 'f':  scratch += '\f'; break;
+            case 'n':  scratch += '\n'; break;
+            case 'r':  scratch += '\r'; break;
+            case 't':  scratch += '\t'; break;
+            case 'v':  scratch += '\v'; break;
+            case '"':  scratch += '"';  break;
+            case '\'': scratch += '\''; break;
+            case '\\': scratch += '\\'; break;
+            default:
+                Error( "unknown escape sequence", b );
+                return false;
+        }
+    }
+
+    out = scratch;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Extract word (whitespace delimited)
+template<typename Handler>
+bool InfoParser<Handler>::ReadWord( std::string_view& out )
+{
+    SkipSpace();
+
+    const char* start{ p };
+
+    while ( p != e && !IsAsciiSpace( *p ) && *p != ';' )
+    {
+        ++p;
+    }
+    return Expand( start, p, out );
+}
+
+// -----------------------------------------------------------------------------
+// Extract string (inside ""), set needMoreLines if \ continuator found
+template<typename Handler>
+bool InfoParser<Handler>::ReadString( std::string_view& out, bool* needMoreLines )
+{
+    SkipSpace();
+
+    if ( p == e || *p != '"' )
+    {
+        Error( "expected \"", p );
+        return false;
+    }
+
+    const char* start{ ++p };
+    bool        escaped{ false };
+
+    // Find end of string, but skip escaped "
+    while ( p != e && ( escaped || *p != '"' ) )
+    {
+        escaped = !escaped && *p == '\\';
+        ++p;
+    }
+
+    if ( p == e )
+    {
+        Error( "unexpected end of line", p );
+        return false;
+    }
+
+    if ( !Expand( start, p++, out ) )
+    {
+        return false;
+    }
+
+    SkipSpace();
+
+    if ( p != e && *p == '\\' )
+    {
+        if ( !needMoreLines )
+        {
+            Error( "unexpected \\", p );
+            return false;
+        }
+
+        ++p;
+        SkipSpace();
+
+        if ( !AtLineEnd() )
+        {
+            Error( "expected end of line after \\", p );
+            return false;
+        }
+        *needMoreLines = true;
+    }
+    else if ( needMoreLines )
+    {
+        *needMoreLines = false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool InfoParser<Handler>::ReadKey( std::string_view& out )
+{
+    SkipSpace();
+    return p != e && *p == '"' ? ReadString( out, nullptr ) : ReadWord( out );
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool InfoParser<Handler>::ReadData( std::string_view& out, bool* needMoreLines )
+{
+    SkipSpace();
+
+    if ( p != e && *p == '"' )
+    {
+        return ReadString( out, needMoreLines );
+    }
+
+    *needMoreLines = false;
+    return ReadWord( out );
+}
+
+// -----------------------------------------------------------------------------
+// #include "file" directive, path is relative to the current working directory as
+// with the Boost parser, or as the include reader resolves it
+template<typename Handler>
+bool InfoParser<Handler>::Directive()
+{
+    ++p; // skip #
+
+    std::string_view directive;
+
+    if ( !ReadWord( directive ) )
+    {
+        return false;
+    }
+
+    if ( directive != "include" )
+    {
+        Error( "unknown directive", lineStart );
+        return false;
+    }
+
+    if ( includeDepth > 100 )
+    {
+        Error( "include depth too large, probably recursive include", lineStart );
+        return false;
+    }
+
+    std::string_view incName;
+
+    if ( !ReadString( incName, nullptr ) )
+    {
+        return false;
+    }
+
+    std::string                     incFname( incName );
+    std::string                     content;
+    std::optional<std::string_view> incText;
+
+    if ( includes )
+    {
+        incText = includes->Read( incName, content, incFname );
+    }
+    else if ( ReadFile( incFname, content ) )
+    {
+        incText = content;
+    }
+
+    if ( !incText )
+    {
+        Error( ( "cannot open include file " + std::string( incName ) ).c_str(), lineStart );
+        return false;
+    }
+
+    // Nested file continues to feed this handler only while there are no errors
+    if ( Forwarding() )
+    {
+        // As with Boost, a subtree that follows attaches to the key before the directive
+        BeginInclude( handler );
+        InfoParser<Handler>( handler, incFname, errors, includeDepth + 1, includes ).Parse( *incText );
+        EndInclude( handler );
+    }
+    else
+    {
+        NullHandler nullHandler;
+        InfoParser<NullHandler>( nullHandler, incFname, errors, includeDepth + 1, includes ).Parse( *incText );
+    }
+
+    // Directive must be followed by end of line
+    SkipSpace();
+
+    if ( p != e )
+    {
+        Error( "expected end of line", p );
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+void InfoParser<Handler>::Line()
+{
+    SkipSpace();
+
+    if ( p != e && *p == '#' )
+    {
+        Directive();
+        return;
+    }
+
+    // While there are characters left in line
+    while ( true )
+    {
+        // Stop parsing on end of line or comment
+        SkipSpace();
+
+        if ( AtLineEnd() )
+        {
+            if ( state == State::data )
+            {
+                state = State::key;
+            }
+            return;
+        }
+
+        switch ( state )
+        {
+            case State::key:
+                if ( *p == '{' )
+                {
+                    if ( !haveLast )
+                    {
+                        Error( "unexpected {", p );
+                        return;
+                    }
+                    EmitEnter();
+                    ++depth;
+                    haveLast = false;
+                    ++p;
+                }
+                else if ( *p == '}' )
+                {
+                    if ( depth == 0 )
+                    {
+                        Error( "unmatched }", p );
+                        return;
+                    }
+                    EmitLeave();
+                    --depth;
+                    haveLast = false;
+                    ++p;
+                }
+                else
+                {
+                    std::string_view key;
+
+                    if ( !ReadKey( key ) )
+                    {
+                        return;
+                    }
+                    EmitKey( key );
+                    haveLast = true;
+                    state    = State::data;
+                }
+                break;
+
+            case State::data:
+                if ( *p == '{' )
+                {
+                    EmitEnter();
+                    ++depth;
+                    haveLast = false;
+                    state    = State::key;
+                    ++p;
+                }
+                else if ( *p == '}' )
+                {
+                    if ( depth == 0 )
+                    {
+                        Error( "unmatched }", p );
+                        return;
+                    }
+                    EmitLeave();
+                    --depth;
+                    haveLast = false;
+                    state    = State::key;
+                    ++p;
+                }
+                else
+                {
+                    std::string_view data;
+                    bool             needMoreLines;
+
+                    if ( !ReadData( data, &needMoreLines ) )
+                    {
+                        state = State::key;
+                        return;
+                    }
+
+                    if ( needMoreLines )
+                    {
+                        pending.assign( data );
+                        state = State::dataCont;
+                    }
+                    else
+                    {
+                        EmitValue( data );
+                        state = State::key;
+                    }
+                }
+                break;
+
+            case State::dataCont:
+                if ( *p == '"' )
+                {
+                    std::string_view data;
+                    bool             needMoreLines;
+
+                    if ( !ReadString( data, &needMoreLines ) )
+                    {
+                        state = State::key;
+                        return;
+                    }
+
+                    pending.append( data );
+
+                    if ( !needMoreLines )
+                    {
+                        EmitValue( pending );
+                        state = State::key;
+                    }
+                }
+                else
+                {
+                    Error( "expected \" after \\ in previous line", p );
+                    state = State::key;
+                    return;
+                }
+                break;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool InfoParser<Handler>::Parse( std::string_view text )
+{
+    std::size_t pos{ 0 };
+
+    while ( pos <= text.size() )
+    {
+        std::size_t eol{ text.find( '\n', pos ) };
+
+        if ( eol == std::string_view::npos )
+        {
+            eol = text.size();
+        }
+
+        ++lineNo;
+        lineStart  = text.data() + pos;
+        p          = lineStart;
+
+        // Line ends at the first NUL, as it does for the Boost parser
+        const char* nul{ static_cast<const char*>( std::memchr( p, '\0', eol - pos ) ) };
+        e = nul ? nul : text.data() + eol;
+
+        // Errors skip the rest of the line, parsing resumes on the next one
+        Line();
+
+        pos = eol + 1;
+    }
+
+    // Unterminated continuation keeps what has been collected
+    if ( state == State::dataCont )
+    {
+        EmitValue( pending );
+    }
+
+    // Check if all {'s have been closed
+    if ( depth != 0 )
+    {
+        errors.push_back( { fname, lineNo, 0, "unmatched {" } );
+    }
+
+    return errors.size() == firstError;
+}
+
+// -----------------------------------------------------------------------------
+// JsonParser
+// -----------------------------------------------------------------------------
+template<typename Handler>
+class JsonParser
+{
+public:
+    JsonParser( Handler& handler, const std::string& fname, std::vector<ParseError>& errors )
+        : handler( handler ), fname( fname ), errors( errors ) {}
+
+    /// @return true if no errors were found
+    bool Parse( std::string_view text );
+
+private:
+    bool Error( const char* message );
+    void SkipSpace();
+    bool Have( char c );
+    bool Expect( char c, const char* message );
+    bool ParseValue();
+    bool ParseObject();
+    bool ParseArray();
+    bool ParseString( std::string_view& out );
+    bool ParseNumber();
+    bool ParseLiteral( std::string_view literal );
+    bool SkipValue();
+    bool ParseEscape();
+    bool ParseHexQuad( unsigned& codepoint );
+    void Feed( unsigned codepoint );
+
+    Handler&                  handler;
+    const std::string&        fname;
+    std::vector<ParseError>&  errors;
+
+    std::string_view          text;
+    const char*               p{ nullptr };
+    const char*               e{ nullptr };
+    std::string               scratch;
+};
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool JsonParser<Handler>::Error( const char* message )
+{
+    std::size_t line{ 1 };
+    const char* lineStart{ text.data() };
+
+    for ( const char* c{ text.data() }; c != p; ++c )
+    {
+        if ( *c == '\n' )
+        {
+            ++line;
+            lineStart = c + 1;
+        }
+    }
+
+    errors.push_back( { fname, line, static_cast<std::size_t>( p - lineStart ) + 1, message } );
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+void JsonParser<Handler>::SkipSpace()
+{
+    while ( p != e && ( *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' ) )
+    {
+        ++p;
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool JsonParser<Handler>::Have( char c )
+{
+    if ( p != e && *p == c )
+    {
+        ++p;
+        return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool JsonParser<Handler>::Expect( char c, const char* message )
+{
+    return Have( c ) || Error( message );
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool JsonParser<Handler>::ParseValue()
+{
+    SkipSpace();
+
+    if ( p == e )
+    {
+        return Error( "expected value" );
+    }
+
+    switch ( *p )
+    {
+        case '{': return ParseObject();
+        case '[': return ParseArray();
+        case 't': return ParseLiteral( "true" );
+        case 'f': return ParseLiteral( "false" );
+        case 'n': return ParseLiteral( "null" );
+        case '"':
+        {
+            std::string_view str;
+
+            if ( !ParseString( str ) )
+            {
+                return false;
+            }
+            handler.Value( str );
+            return true;
+        }
+        default:
+            return ParseNumber();
+    }
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool JsonParser<Handler>::ParseLiteral( std::string_view literal )
+{
+    for ( const char c : literal )
+    {
+        if ( !Have( c ) )
+        {
+            return Error( literal == "true"  ? "expected 'true'"  :
+                          literal == "false" ? "expected 'false'" : "expected 'null'" );
+        }
+    }
+    handler.Value( literal );
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool JsonParser<Handler>::ParseNumber()
+{
+    const char* start{ p };
+    auto        digit  = [this]() { return p != e && *p >= '0' && *p <= '9'; };
+    auto        digits = [&]() { while ( digit() ) ++p; };
+
+    const bool minus{ Have( '-' ) };
+
+    if ( !Have( '0' ) )
+    {
+        if ( p == e || *p < '1' || *p > '9' )
+        {
+            return Error( minus ? "expected digits after -" : "expected value" );
+        }
+        digits();
+    }
+
+    if ( Have( '.' ) )
+    {
+        if ( !digit() )
+        {
+            return Error( "need at least one digit after '.'" );
+        }
+        digits();
+    }
+
+    if ( Have( 'e' ) || Have( 'E' ) )
+    {
+        Have( '+' ) || Have( '-' );
+
+        if ( !digit() )
+        {
+            return Error( "need at least one digit in exponent" );
+        }
+        digits();
+    }
+
+    handler.Value( std::string_view( start, p - start ) );
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Skip value of a rejected key by matching brackets and strings, without events.
+// Content of the skipped value is not validated.
+template<typename Handler>
+bool JsonParser<Handler>::SkipValue()
+{
+    int nesting{ 0 };
+
+    while ( p != e )
+    {
+        switch ( *p )
+        {
+            case '"':
+                for ( ++p; p != e && *p != '"'; ++p )
+                {
+                    if ( *p == '\\' && p + 1 != e )
+                    {
+                        ++p;
+                    }
+                }
+
+                if ( p == e )
+                {
+                    return Error( "unterminated string" );
+                }
+                ++p;
+                break;
+
+            case '{':
+            case '[':
+                ++nesting;
+                ++p;
+                break;
+
+            case '}':
+            case ']':
+                if ( nesting == 0 )
+                {
+                    return true;
+                }
+                --nesting;
+                ++p;
+                break;
+
+            case ',':
+                if ( nesting == 0 )
+                {
+                    return true;
+                }
+                ++p;
+                break;
+
+            default:
+                ++p;
+                break;
+        }
+
+        if ( nesting == 0 && p != e && ( *p == ',' || *p == '}' || *p == ']' ) )
+        {
+            return true;
+        }
+    }
+    return nesting == 0 || Error( "unterminated value" );
+}
+
+// -----------------------------------------------------------------------------
+// Parse string, copies only if it has escapes
+template<typename Handler>
+bool JsonParser<Handler>::ParseString( std::string_view& out )
+{
+    ++p; // skip "
+
+    const char* start{ p };
+    bool        copying{ false };
+
+    while ( true )
+    {
+        if ( p == e )
+        {
+            return Error( "unterminated string" );
+        }
+
+        const auto c{ static_cast<unsigned char>( *p ) };
+
+        if ( c == '"' )
+        {
+            break;
+        }
+
+        if ( c == '\\' )
+        {
+            if ( !copying )
+            {
+                scratch.assign( start, p );
+                copying = true;
+            }
+            ++p;
+
+            if ( !ParseEscape() )
+            {
+                return false;
+            }
+            continue;
+        }
+
+        // Validate UTF-8 sequence and filter out control characters
+        int trailing{ 0 };
+
+        if ( c < 0x20 )
+        {
+            return Error( "invalid code sequence" );
+        }
+        else if ( c >= 0x80 )
+        {
+            static constexpr signed char table[]{ -1, -1, -1, -1, -1, -1, -1, -1, 1, 1, 1, 1, 2, 2, 3, -1 };
+
+            trailing = table[( c & 0x7f ) >> 3];
+
+            if ( trailing < 0 )
+            {
+                return Error( "invalid code sequence" );
+            }
+        }
+
+        const char* cpStart{ p++ };
+
+        for ( int i{ 0 }; i < trailing; ++i, ++p )
+        {
+            if ( p == e || ( static_cast<unsigned char>( *p ) & 0xc0 ) != 0x80 )
+            {
+                return Error( "invalid code sequence" );
+            }
+        }
+
+        if ( copying )
+        {
+            scratch.append( cpStart, p );
+        }
+    }
+
+    out = copying ? std::string_view( scratch ) : std::string_view( start, p - start );
+    ++p; // skip "
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool JsonParser<Handler>::ParseEscape()
+{
+    if ( p == e )
+    {
+        return Error( "invalid escape sequence" );
+    }
+
+    switch ( *p++ )
+    {
+        case '"':  scratch += '"';  return true;
+        case '\\': scratch += '\\'; return true;
+        case '/':  scratch += '/';  return true;
+        case 'b':  scratch += '\b'; return true;
+        case 'f':  scratch += '\f'; return true;
+        case 'n':  scratch += '\n'; return true;
+        case 'r':  scratch += '\r'; return true;
+        case 't':  scratch += '\t'; return true;
+        case 'u':  break;
+        default:
+            --p;
+            return Error( "invalid escape sequence" );
+    }
+
+    unsigned codepoint;
+
+    if ( !ParseHexQuad( codepoint ) )
+    {
+        return false;
+    }
+
+    if ( ( codepoint & 0xfc00 ) == 0xdc00 )
+    {
+        return Error( "invalid codepoint, stray low surrogate" );
+    }
+
+    if ( ( codepoint & 0xfc00 ) == 0xd800 )
+    {
+        unsigned low;
+
+        if ( !Expect( '\\', "invalid codepoint, stray high surrogate" ) ||
+             !Expect( 'u', "expected codepoint reference after high surrogate" ) ||
+             !ParseHexQuad( low ) )
+        {
+            return false;
+        }
+
+        if ( ( low & 0xfc00 ) != 0xdc00 )
+        {
+            return Error( "expected low surrogate after high surrogate" );
+        }
+        codepoint = 0x010000 + ( ( ( codepoint & 0x3ff ) << 10 ) | ( low & 0x3ff ) );
+    }
+
+    Feed( codepoint );
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool JsonParser<Handler>::ParseHexQuad( unsigned& codepoint )
+{
+    codepoint = 0;
+
+    for ( int i{ 0 }; i < 4; ++i, ++p )
+    {
+        if ( p == e || !std::isxdigit( static_cast<unsigned char>( *p ) ) )
+        {
+            return Error( "invalid escape sequence" );
+        }
+
+        const char c{ *p };
+        codepoint = codepoint * 16 + ( c <= '9' ? c - '0' : ( c | 0x20 ) - 'a' + 10 );
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Append codepoint as UTF-8
+template<typename Handler>
+void JsonParser<Handler>::Feed( unsigned codepoint )
+{
+    auto trail = []( unsigned u ) { return static_cast<char>( 0x80 | ( u & 0x3f ) ); };
+
+    if ( codepoint <= 0x7f )
+    {
+        scratch += static_cast<char>( codepoint );
+    }
+    else if ( codepoint <= 0x7ff )
+    {
+        scratch += static_cast<char>( 0xc0 | ( codepoint >> 6 ) );
+        scratch += trail( codepoint );
+    }
+    else if ( codepoint <= 0xffff )
+    {
+        scratch += static_cast<char>( 0xe0 | ( codepoint >> 12 ) );
+        scratch += trail( codepoint >> 6 );
+        scratch += trail( codepoint );
+    }
+    else
+    {
+        scratch += static_cast<char>( 0xf0 | ( codepoint >> 18 ) );
+        scratch += trail( codepoint >> 12 );
+        scratch += trail( codepoint >> 6 );
+        scratch += trail( codepoint );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Object members become children, top-level object members go to the root
+template<typename Handler>
+bool JsonParser<Handler>::ParseObject()
+{
+    ++p; // skip {
+    SkipSpace();
+
+    if ( Have( '}' ) )
+    {
+        return true;
+    }
+
+    do
+    {
+        SkipSpace();
+
+        if ( p == e || *p != '"' )
+        {
+            return Error( "expected key string" );
+        }
+
+        std::string_view key;
+
+        if ( !ParseString( key ) )
+        {
+            return false;
+        }
+        const bool accepted{ AcceptKey( handler, key ) };
+
+        SkipSpace();
+
+        if ( !Expect( ':', "expected ':'" ) )
+        {
+            return false;
+        }
+
+        SkipSpace();
+
+        if ( !accepted )
+        {
+            if ( !SkipValue() )
+            {
+                return false;
+            }
+        }
+        else if ( p != e && ( *p == '{' || *p == '[' ) )
+        {
+            handler.Enter();
+            if ( !ParseValue() )
+            {
+                return false;
+            }
+            handler.Leave();
+        }
+        else if ( !ParseValue() )
+        {
+            return false;
+        }
+
+        SkipSpace();
+    } while ( Have( ',' ) );
+
+    return Expect( '}', "expected '}' or ','" );
+}
+
+// -----------------------------------------------------------------------------
+// Array elements become children with empty keys
+template<typename Handler>
+bool JsonParser<Handler>::ParseArray()
+{
+    ++p; // skip [
+    SkipSpace();
+
+    if ( Have( ']' ) )
+    {
+        return true;
+    }
+
+    do
+    {
+        const bool accepted{ AcceptKey( handler, {} ) };
+        SkipSpace();
+
+        if ( !accepted )
+        {
+            if ( !SkipValue() )
+            {
+                return false;
+            }
+        }
+        else if ( p != e && ( *p == '{' || *p == '[' ) )
+        {
+            handler.Enter();
+            if ( !ParseValue() )
+            {
+                return false;
+            }
+            handler.Leave();
+        }
+        else if ( !ParseValue() )
+        {
+            return false;
+        }
+
+        SkipSpace();
+    } while ( Have( ',' ) );
+
+    return Expect( ']', "expected ']' or ','" );
+}
+
+// -----------------------------------------------------------------------------
+template<typename Handler>
+bool JsonParser<Handler>::Parse( std::string_view input )
+{
+    text = input;
+    p    = text.data();
+    e    = text.data() + text.size();
+
+    // Skip UTF-8 BOM
+    if ( text.starts_with( "\xEF\xBB\xBF" ) )
+    {
+        p += 3;
+    }
+
+    if ( !ParseValue() )
+    {
+        return false;
+    }
+
+    SkipSpace();
+
+    return p == e || Error( "garbage after data" );
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// Parser entry points
+// -----------------------------------------------------------------------------
+/// Parse INFO text, events stop at the first error but all line errors are reported
+/// @param text Input buffer
+/// @param fname File name for error reporting
+/// @param handler Event handler
+/// @param errors Errors are appended here
+/// @param includes Reader of #include files, null reads them from disk relative
+///                 to the current working directory, as the Boost parser does
+/// @return true if no errors were found
+template<typename Handler>
+bool ParseInfo( std::string_view text, const std::string& fname, Handler& handler, std::vector<ParseError>& errors,
+                IncludeReader* includes = nullptr )
+{
+    return detail::InfoParser<Handler>( handler, fname, errors, 0, includes ).Parse( text );
+}
+
+// -----------------------------------------------------------------------------
+/// Parse JSON text, parsing stops at the first error
+/// @param text Input buffer
+/// @param fname File name for error reporting
+/// @param handler Event handler
+/// @param errors Errors are appended here
+/// @return true if no errors were found
+template<typename Handler>
+bool ParseJson( std::string_view text, const std::string& fname, Handler& handler, std::vector<ParseError>& errors )
+{
+    return detail::JsonParser<Handler>( handler, fname, errors ).Parse( text );
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeParsers_H
@@ -0,0 +1,240 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Building blocks of the pipelined load, see PtreeLoader::SetPipeline().
+// A load runs as three stages on their own threads:
+//   read  : resolves requested include paths, reads the files and requests
+//           the includes a pre-scan finds in them, see PtreeScanner.h
+//   parse : parses files, matches pre-scanned includes with the includes at
+//           their top level and requests the ones the pre-scan missed
+//   merge : the calling thread, merges parsed files in depth-first order
+// Results of pre-scanned requests that do not match are never merged.
+// Read and parse hand over through bounded lock-free single-producer queues.
+// Include requests flow back from parse to read through an unbounded queue:
+// if it were bounded, a full read queue and a full request queue could block
+// both stages on each other.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreePipeline_H
+#define PtreePipeline_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <filesystem>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include "PtreeCache.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+// SpscQueue : bounded lock-free queue for one producer and one consumer
+// -----------------------------------------------------------------------------
+template<typename T, std::size_t Capacity>
+class SpscQueue
+{
+public:
+    SpscQueue()                               = default;
+    SpscQueue( const SpscQueue& )             = delete;
+    SpscQueue& operator=( const SpscQueue& )  = delete;
+
+    /// Append value, waits while the queue is full
+    void Push( T value )
+    {
+        const std::size_t t{ tail.load( std::memory_order_relaxed ) };
+        const std::size_t next{ ( t + 1 ) % size };
+
+        for ( std::size_t h{ head.load( std::memory_order_acquire ) }; next == h;
+              h = head.load( std::memory_order_acquire ) )
+        {
+            head.wait( h, std::memory_order_acquire );
+        }
+
+        slots[t] = std::move( value );
+        tail.store( next, std::memory_order_release );
+        tail.notify_one();
+    }
+
+    /// Remove first value, waits while the queue is empty
+    T Pop()
+    {
+        const std::size_t h{ head.load( std::memory_order_relaxed ) };
+
+        for ( std::size_t t{ tail.load( std::memory_order_acquire ) }; h == t;
+              t = tail.load( std::memory_order_acquire ) )
+        {
+            tail.wait( t, std::memory_order_acquire );
+        }
+
+        T value{ std::move( slots[h] ) };
+        head.store( ( h + 1 ) % size, std::memory_order_release );
+        head.notify_one();
+        return value;
+    }
+
+private:
+    /// One slot stays free to tell a full queue from an empty one
+    static constexpr std::size_t size{ Capacity + 1 };
+
+    std::array<T, size>      slots;
+    alignas( 64 ) std::atomic<std::size_t> head{ 0 };
+    alignas( 64 ) std::atomic<std::size_t> tail{ 0 };
+};
+
+// -----------------------------------------------------------------------------
+// Pipeline : state shared by the stages of one pipelined load
+// -----------------------------------------------------------------------------
+struct Pipeline
+{
+    using Duration = std::chrono::steady_clock::duration;
+
+    static constexpr std::size_t noRequest{ static_cast<std::size_t>( -1 ) };
+    static constexpr std::size_t queueSize{ 16 };
+
+    /// Resolved paths of a file and the files it is included by, shared by their requests
+    struct Chain
+    {
+        std::filesystem::path        path;
+        std::shared_ptr<const Chain> parent;
+
+        static bool Contains( const Chain* chain, const std::filesystem::path& path )
+        {
+            for ( ; chain; chain = chain->parent.get() )
+            {
+                if ( chain->path == path )
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    /// File to read, noRequest id stops the pipeline
+    struct Request
+    {
+        std::size_t                  id{ noRequest };
+        std::filesystem::path        path;       ///< As written in the include key
+        std::filesystem::path        parentDir;  ///< Directory relative paths are joined to
+        int                          depth{ 0 };
+        std::shared_ptr<const Chain> chain;      ///< Including files, null for the root
+    };
+
+    /// Include requested by the read stage
+    struct Scanned
+    {
+        std::size_t id{ noRequest };
+        std::string path;
+    };
+
+    /// File read by the read stage
+    struct Read
+    {
+        std::size_t                  id{ noRequest };
+        int                          depth{ 0 };
+        ResolvedPath                 resolved;
+        std::string                  content;
+        std::string_view             view;             ///< Content if not copied into content
+        bool                         failed{ false };  ///< File exists but could not be read
+        bool                         looped{ false };  ///< File is on its own include chain, not read
+        bool                         pathCacheHit{ false };
+        std::shared_ptr<const Chain> chain;            ///< This file and the files including it
+        std::vector<Scanned>         scanned;          ///< Pre-scanned includes, in order
+        Duration                     resolveTime{};
+        Duration                     readTime{};
+    };
+
+    /// File parsed by the parse stage
+    struct Result
+    {
+        std::size_t              id{ noRequest };
+        ResolvedPath             resolved;
+        LoadCache::FragmentPtr   fragment;     ///< Null if the file does not exist or is looped
+        std::vector<std::size_t> includes;     ///< Request ids of top-level includes, in order
+        bool                     pathCacheHit{ false };
+        bool                     fragmentCacheHit{ false };
+        Duration                 resolveTime{};
+        Duration                 parseTime{};  ///< Reading and parsing
+    };
+
+    /// Append include request, called by the merge stage once and by the read and parse stages
+    void Enqueue( Request request )
+    {
+        {
+            std::lock_guard lock( requestMutex );
+            requests.push_back( std::move( request ) );
+        }
+        requestReady.notify_one();
+    }
+
+    /// Take next include request, waits while there is none
+    Request NextRequest()
+    {
+        std::unique_lock lock( requestMutex );
+        requestReady.wait( lock, [this]() { return !requests.empty(); } );
+
+        Request request{ std::move( requests.front() ) };
+        requests.pop_front();
+        return request;
+    }
+
+    /// Result for request id, received results for later requests are kept
+    Result Await( std::size_t id )
+    {
+        if ( const auto it{ received.find( id ) }; it != received.end() )
+        {
+            Result result{ std::move( it->second ) };
+            received.erase( it );
+            return result;
+        }
+
+        while ( true )
+        {
+            Result result{ parsed.Pop() };
+
+            if ( result.id == id )
+            {
+                return result;
+            }
+            received.emplace( result.id, std::move( result ) );
+        }
+    }
+
+    /// Stop the stages, results not yet merged are discarded
+    void Stop()
+    {
+        {
+            std::lock_guard lock( requestMutex );
+            requests.push_front( {} );
+        }
+        requestReady.notify_one();
+
+        while ( parsed.Pop().id != noRequest )
+        {
+        }
+    }
+
+    std::mutex                              requestMutex;
+    std::condition_variable                 requestReady;
+    std::deque<Request>                     requests;      ///< Unbounded, see file comment
+    SpscQueue<Read, queueSize>              read;          ///< Read to parse
+    SpscQueue<Result, queueSize>            parsed;        ///< Parse to merge
+    std::unordered_map<std::size_t, Result> received;      ///< Merge stage only
+    std::atomic<std::size_t>                nextId{ 1 };   ///< Read and parse stages, 0 is the root
+};
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreePipeline_H
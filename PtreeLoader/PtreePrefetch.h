@@ -0,0 +1,105 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Prefetch list: files of the last successful load in access order, kept
+// between runs. Issued at the start of the next load, it asks the OS to read
+// the expected files into the page cache while the include graph is still
+// being discovered, so a cold start waits for the disk once rather than once
+// per include level.
+// Hints are given with posix_fadvise(POSIX_FADV_WILLNEED) where available and
+// are a no-op elsewhere.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreePrefetch_H
+#define PtreePrefetch_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+// PrefetchList
+// -----------------------------------------------------------------------------
+class PrefetchList
+{
+public:
+    /// Read list written by Write(), one path per line
+    /// @return false if the file could not be read, the list is then empty
+    bool Read( const std::filesystem::path& fsPath )
+    {
+        files.clear();
+
+        std::ifstream stream( fsPath, std::ios::binary );
+        std::string   line;
+
+        while ( std::getline( stream, line ) )
+        {
+            if ( !line.empty() )
+            {
+                files.emplace_back( line );
+            }
+        }
+        return !stream.bad() && stream.eof();
+    }
+
+    /// Write list, one path per line
+    /// @return false if the file could not be written
+    bool Write( const std::filesystem::path& fsPath ) const
+    {
+        std::ofstream stream( fsPath, std::ios::binary );
+
+        for ( const auto& fsFile : files )
+        {
+            stream << fsFile.generic_string() << '\n';
+        }
+        return stream.good();
+    }
+
+    /// Ask the OS to read the listed files ahead, returns without waiting for them
+    /// @return Number of files hinted, missing files are skipped
+    std::size_t Prefetch() const
+    {
+        std::size_t hinted{ 0 };
+
+#if !defined( _WIN32 ) && defined( POSIX_FADV_WILLNEED )
+        for ( const auto& fsFile : files )
+        {
+            const int fd{ ::open( fsFile.c_str(), O_RDONLY | O_CLOEXEC ) };
+
+            if ( fd < 0 )
+            {
+                continue;
+            }
+
+            hinted += ::posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED ) == 0;
+            ::close( fd );
+        }
+#endif
+        return hinted;
+    }
+
+    /// Replace list with files in access order
+    void Assign( std::vector<std::filesystem::path> accessOrder ) { files = std::move( accessOrder ); }
+
+    const std::vector<std::filesystem::path>& Files() const { return files; }
+
+private:
+    std::vector<std::filesystem::path> files;
+};
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreePrefetch_H
@@ -0,0 +1,151 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Projection: the set of paths a loader should keep.
+// Patterns are dotted key paths where "*" matches any single key, e.g.
+// "Data.field1" or "Colors.*.name". A node is kept if its path lies on the way
+// to a pattern or inside a subtree selected by one. ProjectionFilter applies a
+// projection to parser events and rejects other keys, so the parsers skip
+// their values and subtrees without reporting them.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeProjection_H
+#define PtreeProjection_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <vector>
+#include <initializer_list>
+#include "PtreeUtils.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+// Projection
+// -----------------------------------------------------------------------------
+class Projection
+{
+public:
+    Projection() = default;
+
+    Projection( std::initializer_list<std::string_view> patterns )
+    {
+        for ( const auto pattern : patterns )
+        {
+            Add( pattern );
+        }
+    }
+
+    /// Add pattern, keys separated by separator, "*" matches any key
+    void Add( std::string_view pattern, char separator = '.' )
+    {
+        std::vector<std::string> segments;
+
+        while ( true )
+        {
+            const std::size_t sep{ pattern.find( separator ) };
+            segments.emplace_back( pattern.substr( 0, sep ) );
+
+            if ( sep == std::string_view::npos )
+            {
+                break;
+            }
+            pattern.remove_prefix( sep + 1 );
+        }
+        patterns.push_back( std::move( segments ) );
+    }
+
+    std::size_t Size() const { return patterns.size(); }
+
+private:
+    template<typename Handler>
+    friend class ProjectionFilter;
+
+    std::vector<std::vector<std::string>> patterns;
+};
+
+// -----------------------------------------------------------------------------
+// ProjectionFilter : parser handler that forwards projected events only
+// -----------------------------------------------------------------------------
+template<typename Handler>
+class ProjectionFilter
+{
+public:
+    ProjectionFilter( const Projection& projection, Handler& handler )
+        : projection( projection ), handler( handler ), levels( 2 )
+    {
+        for ( std::size_t i{ 0 }; i < projection.patterns.size(); ++i )
+        {
+            levels[0].live.push_back( i );
+        }
+    }
+
+    /// @return false if the key is outside the projection
+    bool Key( std::string_view key )
+    {
+        if ( depth + 1 == levels.size() )
+        {
+            levels.emplace_back();
+        }
+
+        const Level& level{ levels[depth] };
+
+        // Child level is prepared for every key, Enter() uses the last one
+        Level& child{ levels[depth + 1] };
+        child.selected = level.selected;
+        child.live.clear();
+
+        if ( !level.selected )
+        {
+            for ( const std::size_t i : level.live )
+            {
+                const std::vector<std::string>& segments{ projection.patterns[i] };
+
+                if ( segments[depth] != "*" && segments[depth] != key )
+                {
+                    continue;
+                }
+
+                if ( segments.size() == depth + 1 )
+                {
+                    child.selected = true;
+                    break;
+                }
+                child.live.push_back( i );
+            }
+
+            if ( !child.selected && child.live.empty() )
+            {
+                return false;
+            }
+        }
+        return detail::AcceptKey( handler, key );
+    }
+
+    void Value( std::string_view value ) { handler.Value( value ); }
+    void Enter()                         { ++depth; handler.Enter(); }
+    void Leave()                         { --depth; handler.Leave(); }
+    void BeginInclude()                  { detail::BeginInclude( handler ); }
+    void EndInclude()                    { detail::EndInclude( handler ); }
+
+private:
+    struct Level
+    {
+        bool                     selected{ false };  ///< Whole subtree is kept
+        std::vector<std::size_t> live;               ///< Patterns matched so far
+    };
+
+    const Projection&  projection;
+    Handler&           handler;
+    std::vector<Level> levels;
+    std::size_t        depth{ 0 };
+};
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeProjection_H
@@ -0,0 +1,177 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Include pre-scanners: find include directives in a raw buffer without
+// parsing it, so that a pipelined load can read included files while their
+// parent is still being parsed.
+// A scanner looks for the include key with string_view::find (a memchr driven
+// search) and accepts occurrences that look like a key in the given format.
+// Results are hints: a key nested in a subtree or inside a multi-line value
+// may be reported, and values with escapes other than the common ones are
+// not. Callers verify them against the parsed tree.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeScanner_H
+#define PtreeScanner_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+namespace detail
+{
+constexpr bool IsBlank( char c )
+{
+    return c == ' ' || c == '\t';
+}
+
+/// Unescape quoted text starting after the opening quote, up to the closing quote
+/// @param escapes Characters accepted after a backslash, standing for themselves
+/// @return Nothing if the text is not closed on the same line or has other escapes
+inline std::optional<std::string> ScanQuoted( std::string_view text, std::size_t pos, std::string_view escapes )
+{
+    std::string value;
+
+    for ( ; pos < text.size(); ++pos )
+    {
+        const char c{ text[pos] };
+
+        if ( c == '"' )
+        {
+            return value;
+        }
+        if ( c == '\n' )
+        {
+            break;
+        }
+        if ( c == '\\' )
+        {
+            if ( ++pos == text.size() || escapes.find( text[pos] ) == std::string_view::npos )
+            {
+                break;
+            }
+        }
+        value += text[pos];
+    }
+    return std::nullopt;
+}
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+/// Include candidates of INFO text: key first on its line, followed by a word or string
+inline std::vector<std::string> ScanInfoIncludes( std::string_view text, std::string_view key )
+{
+    std::vector<std::string> includes;
+
+    for ( std::size_t pos{ text.find( key ) }; pos != std::string_view::npos; pos = text.find( key, pos + 1 ) )
+    {
+        std::size_t start{ pos };
+
+        while ( start > 0 && detail::IsBlank( text[start - 1] ) )
+        {
+            --start;
+        }
+
+        std::size_t p{ pos + key.size() };
+
+        if ( ( start > 0 && text[start - 1] != '\n' ) || p == text.size() || !detail::IsBlank( text[p] ) )
+        {
+            continue;
+        }
+
+        while ( p < text.size() && detail::IsBlank( text[p] ) )
+        {
+            ++p;
+        }
+
+        if ( p < text.size() && text[p] == '"' )
+        {
+            if ( auto value{ detail::ScanQuoted( text, p + 1, "\"\\" ) } )
+            {
+                includes.push_back( std::move( *value ) );
+            }
+            continue;
+        }
+
+        const std::size_t end{ std::min( text.find_first_of( " \t\r\n;", p ), text.size() ) };
+        const std::string_view word{ text.substr( p, end - p ) };
+
+        if ( !word.empty() && word.find( '\\' ) == std::string_view::npos )
+        {
+            includes.emplace_back( word );
+        }
+    }
+    return includes;
+}
+
+// -----------------------------------------------------------------------------
+/// Include candidates of JSON text: quoted key followed by a colon and a string
+inline std::vector<std::string> ScanJsonIncludes( std::string_view text, std::string_view key )
+{
+    std::vector<std::string> includes;
+    const std::string        quoted{ '"' + std::string( key ) + '"' };
+    const auto               skipSpace{ [&]( std::size_t p ) { return std::min( text.find_first_not_of( " \t\r\n", p ), text.size() ); } };
+
+    for ( std::size_t pos{ text.find( quoted ) }; pos != std::string_view::npos; pos = text.find( quoted, pos + 1 ) )
+    {
+        std::size_t p{ skipSpace( pos + quoted.size() ) };
+
+        if ( p == text.size() || text[p] != ':' )
+        {
+            continue;
+        }
+
+        p = skipSpace( p + 1 );
+
+        if ( p < text.size() && text[p] == '"' )
+        {
+            if ( auto value{ detail::ScanQuoted( text, p + 1, "\"\\/" ) } )
+            {
+                includes.push_back( std::move( *value ) );
+            }
+        }
+    }
+    return includes;
+}
+
+// -----------------------------------------------------------------------------
+/// Include candidates of XML text: element without attributes holding plain text
+inline std::vector<std::string> ScanXmlIncludes( std::string_view text, std::string_view key )
+{
+    std::vector<std::string> includes;
+    const std::string        open{ '<' + std::string( key ) + '>' };
+    const std::string        close{ "</" + std::string( key ) + '>' };
+
+    for ( std::size_t pos{ text.find( open ) }; pos != std::string_view::npos; pos = text.find( open, pos + 1 ) )
+    {
+        const std::size_t p{ pos + open.size() };
+        const std::size_t end{ text.find( close, p ) };
+
+        if ( end == std::string_view::npos )
+        {
+            break;
+        }
+
+        const std::string_view value{ text.substr( p, end - p ) };
+
+        if ( value.find_first_of( "<&" ) == std::string_view::npos )
+        {
+            includes.emplace_back( value );
+        }
+    }
+    return includes;
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeScanner_H
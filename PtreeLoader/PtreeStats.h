@@ -0,0 +1,116 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Load statistics collected by PtreeLoader.
+// Counters and per-phase wall times are kept in a plain struct and can be
+// exported as JSON or in Prometheus text exposition format.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeStats_H
+#define PtreeStats_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+// LoadStats
+// -----------------------------------------------------------------------------
+struct LoadStats
+{
+    using Duration = std::chrono::nanoseconds;
+
+    std::uint64_t filesLoaded{ 0 };       ///< Files successfully parsed and merged
+    std::uint64_t bytesRead{ 0 };         ///< Total size of parsed files
+    std::uint64_t nodesCreated{ 0 };      ///< Nodes merged into the root ptree
+    std::uint64_t pathCacheHits{ 0 };     ///< Paths resolved from the path cache or the LoadCache
+    std::uint64_t fragmentCacheHits{ 0 }; ///< Files taken parsed from the LoadCache
+    std::uint64_t errors{ 0 };            ///< Missing files, parse errors and include loops
+    int           maxIncludeDepth{ 0 };   ///< Deepest include chain (root file is 1)
+
+    Duration      resolveTime{};          ///< Path canonicalization and existence checks
+    Duration      parseTime{};            ///< File reading and parsing
+    Duration      mergeTime{};            ///< Merging parsed subtrees into the root
+    Duration      totalTime{};            ///< Wall time of the public Load() calls
+
+    /// Export as a single JSON object, durations in seconds
+    std::string ToJson() const;
+
+    /// Export in Prometheus text exposition format
+    /// @param prefix Metric name prefix
+    std::string ToPrometheus( const std::string& prefix = "ptree_loader" ) const;
+};
+
+// -----------------------------------------------------------------------------
+// LoadStats definition
+// -----------------------------------------------------------------------------
+namespace detail
+{
+inline double Seconds( LoadStats::Duration d )
+{
+    return std::chrono::duration<double>( d ).count();
+}
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+inline std::string LoadStats::ToJson() const
+{
+    std::stringstream ss;
+
+    ss << "{"
+       << "\"files_loaded\":"        << filesLoaded                   << ","
+       << "\"bytes_read\":"          << bytesRead                     << ","
+       << "\"nodes_created\":"       << nodesCreated                  << ","
+       << "\"path_cache_hits\":"     << pathCacheHits                 << ","
+       << "\"fragment_cache_hits\":" << fragmentCacheHits             << ","
+       << "\"errors\":"              << errors                        << ","
+       << "\"max_include_depth\":"   << maxIncludeDepth               << ","
+       << "\"resolve_seconds\":"     << detail::Seconds( resolveTime ) << ","
+       << "\"parse_seconds\":"       << detail::Seconds( parseTime )   << ","
+       << "\"merge_seconds\":"       << detail::Seconds( mergeTime )   << ","
+       << "\"total_seconds\":"       << detail::Seconds( totalTime )
+       << "}";
+    return ss.str();
+}
+
+// -----------------------------------------------------------------------------
+inline std::string LoadStats::ToPrometheus( const std::string& prefix ) const
+{
+    std::stringstream ss;
+
+    auto metric = [&]( const char* name, const char* type, const char* help, const auto& value )
+    {
+        ss << "# HELP " << prefix << '_' << name << ' ' << help << '\n'
+           << "# TYPE " << prefix << '_' << name << ' ' << type << '\n'
+           << prefix << '_' << name << ' ' << value << '\n';
+    };
+
+    metric( "files_loaded_total",        "counter", "Files parsed and merged.",            filesLoaded );
+    metric( "bytes_read_total",          "counter", "Bytes of parsed files.",               bytesRead );
+    metric( "nodes_created_total",       "counter", "Nodes merged into the root ptree.",    nodesCreated );
+    metric( "path_cache_hits_total",     "counter", "Paths resolved from cache.",           pathCacheHits );
+    metric( "fragment_cache_hits_total", "counter", "Files taken parsed from cache.",       fragmentCacheHits );
+    metric( "errors_total",              "counter", "Missing files, parse errors, loops.",  errors );
+    metric( "max_include_depth",         "gauge",   "Deepest include chain.",               maxIncludeDepth );
+
+    // Phase times accumulate over loads
+    ss << "# HELP " << prefix << "_phase_seconds_total Wall time spent per load phase.\n"
+       << "# TYPE " << prefix << "_phase_seconds_total counter\n"
+       << prefix << "_phase_seconds_total{phase=\"resolve\"} " << detail::Seconds( resolveTime ) << '\n'
+       << prefix << "_phase_seconds_total{phase=\"parse\"} "   << detail::Seconds( parseTime )   << '\n'
+       << prefix << "_phase_seconds_total{phase=\"merge\"} "   << detail::Seconds( mergeTime )   << '\n'
+       << prefix << "_phase_seconds_total{phase=\"total\"} "   << detail::Seconds( totalTime )   << '\n';
+    return ss.str();
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeStats_H
@@ -0,0 +1,167 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Optional tracing of load phases.
+// TraceRecorder collects complete ("X") events from any thread and writes them
+// in Chrome trace JSON format, viewable in Perfetto UI or chrome://tracing.
+// TraceScope is a RAII helper which does nothing when no recorder is attached.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeTrace_H
+#define PtreeTrace_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include "PtreeUtils.h"
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+// TraceRecorder
+// -----------------------------------------------------------------------------
+class TraceRecorder
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TraceRecorder() : origin( Clock::now() ) {}
+    TraceRecorder( const TraceRecorder& )             = delete;
+    TraceRecorder& operator=( const TraceRecorder& )  = delete;
+
+    /// Record a complete event, thread-safe
+    /// @param name Event name
+    /// @param category Event category
+    /// @param start Start time point
+    /// @param end End time point
+    /// @param detail Optional free-form argument (e.g. file path)
+    void Record( const char* name, const char* category,
+                 Clock::time_point start, Clock::time_point end, std::string detail = {} );
+
+    /// Chrome trace JSON document
+    std::string ToChromeTrace() const;
+
+    /// Write Chrome trace JSON document to file
+    /// @return false if the file could not be written
+    bool Write( const std::filesystem::path& fsPath ) const;
+
+private:
+    struct Event
+    {
+        const char*       name;
+        const char*       category;
+        Clock::time_point start;
+        Clock::time_point end;
+        int               tid;
+        std::string       detail;
+    };
+
+    const Clock::time_point                  origin;
+    mutable std::mutex                       mutex;
+    std::vector<Event>                       events;
+    std::unordered_map<std::thread::id, int> threads;
+};
+
+// -----------------------------------------------------------------------------
+// TraceScope
+// -----------------------------------------------------------------------------
+class TraceScope
+{
+public:
+    TraceScope( TraceRecorder* recorder, const char* name, const char* category, std::string detail = {} )
+        : recorder( recorder ), name( name ), category( category ), detail( std::move( detail ) )
+    {
+        if ( recorder )
+        {
+            start = TraceRecorder::Clock::now();
+        }
+    }
+    TraceScope( const TraceScope& )             = delete;
+    TraceScope& operator=( const TraceScope& )  = delete;
+
+    ~TraceScope()
+    {
+        if ( recorder )
+        {
+            recorder->Record( name, category, start, TraceRecorder::Clock::now(), std::move( detail ) );
+        }
+    }
+
+private:
+    TraceRecorder*                   recorder;
+    const char*                      name;
+    const char*                      category;
+    std::string                      detail;
+    TraceRecorder::Clock::time_point start;
+};
+
+// -----------------------------------------------------------------------------
+// TraceRecorder definition
+// -----------------------------------------------------------------------------
+inline void TraceRecorder::Record( const char* name, const char* category,
+                                   Clock::time_point start, Clock::time_point end, std::string detail )
+{
+    std::lock_guard lock( mutex );
+
+    const auto [it, inserted]{ threads.try_emplace( std::this_thread::get_id(),
+                                                    static_cast<int>( threads.size() ) + 1 ) };
+
+    events.push_back( { name, category, start, end, it->second, std::move( detail ) } );
+}
+
+// -----------------------------------------------------------------------------
+inline std::string TraceRecorder::ToChromeTrace() const
+{
+    using Micro = std::chrono::duration<double, std::micro>;
+
+    std::lock_guard   lock( mutex );
+    std::stringstream ss;
+    const char*       delim{ "" };
+
+    ss << std::fixed << std::setprecision( 3 );
+    ss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for ( const auto& e : events )
+    {
+        ss << delim << "\n{\"name\":\"" << detail::JsonEscape( e.name ) << '"'
+           << ",\"cat\":\"" << detail::JsonEscape( e.category ) << '"'
+           << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.tid
+           << ",\"ts\":"  << Micro( e.start - origin ).count()
+           << ",\"dur\":" << Micro( e.end - e.start ).count();
+
+        if ( !e.detail.empty() )
+        {
+            ss << ",\"args\":{\"detail\":\"" << detail::JsonEscape( e.detail ) << "\"}";
+        }
+        ss << '}';
+        delim = ",";
+    }
+
+    ss << "\n]}\n";
+    return ss.str();
+}
+
+// -----------------------------------------------------------------------------
+inline bool TraceRecorder::Write( const std::filesystem::path& fsPath ) const
+{
+    std::ofstream stream( fsPath, std::ios::binary );
+
+    stream << ToChromeTrace();
+    return stream.good();
+}
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+// -----------------------------------------------------------------------------
+#endif // PtreeTrace_H
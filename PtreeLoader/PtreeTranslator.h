@@ -0,0 +1,181 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Value translators built on std::from_chars / std::to_chars.
+// Boost.PropertyTree converts values through std::stringstream by default,
+// which allocates and consults the locale on every get<T>(). FastTranslator
+// converts arithmetic types without either, accepting the input of the
+// stream translator: surrounding whitespace, a leading '+', and "true" /
+// "false" as well as 0 / 1 for bool. Non-finite spellings such as "inf" or
+// "nan", which from_chars would parse, are rejected as the stream rejects
+// them. Unlike the stream, negative numbers are rejected for unsigned types
+// instead of wrapping around.
+//
+// Pass FastTranslator<T>() to get_value() / get<T>() explicitly, or define
+// PTREE_LOADER_FAST_TRANSLATOR before including PtreeLoader to make it the
+// default translator of bpt::ptree for all arithmetic types. The macro changes
+// which translator get<T>() instantiates, so it must be defined the same way
+// in every translation unit of the program, the ptree_loader library sources
+// included (e.g. as a compile definition of the whole build), or the program
+// violates the one-definition rule.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeTranslator_H
+#define PtreeTranslator_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <optional>
+#include <charconv>
+#include <cmath>
+#include <type_traits>
+#include <boost/optional.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader
+{
+
+// -----------------------------------------------------------------------------
+namespace detail
+{
+template<typename T>
+inline constexpr bool isCharacter{ std::is_same_v<T, char>     || std::is_same_v<T, wchar_t>  ||
+                                   std::is_same_v<T, char8_t>  || std::is_same_v<T, char16_t> ||
+                                   std::is_same_v<T, char32_t> };
+
+/// Whitespace as accepted by the stream translator in the classic locale
+constexpr bool IsStreamSpace( char c )
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+constexpr std::string_view TrimSpace( std::string_view str )
+{
+    while ( !str.empty() && IsStreamSpace( str.front() ) )
+    {
+        str.remove_prefix( 1 );
+    }
+    while ( !str.empty() && IsStreamSpace( str.back() ) )
+    {
+        str.remove_suffix( 1 );
+    }
+    return str;
+}
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+/// Types converted by FastTranslator: bool, integers except characters, floating point
+template<typename T>
+concept FastConvertible = std::is_arithmetic_v<T> && !detail::isCharacter<T>;
+
+// -----------------------------------------------------------------------------
+/// Convert value text to T
+/// @return Nothing if the text, without surrounding whitespace, is not a T
+template<FastConvertible T>
+std::optional<T> FromChars( std::string_view str )
+{
+    str = detail::TrimSpace( str );
+
+    if constexpr ( std::is_same_v<T, bool> )
+    {
+        if ( str == "1" || str == "true" )
+        {
+            return true;
+        }
+        if ( str == "0" || str == "false" )
+        {
+            return false;
+        }
+        return std::nullopt;
+    }
+    else
+    {
+        // from_chars rejects the plus sign streams accept
+        if ( str.size() > 1 && str.front() == '+' && str[1] != '-' )
+        {
+            str.remove_prefix( 1 );
+        }
+
+        T value{};
+        const auto [end, ec]{ std::from_chars( str.data(), str.data() + str.size(), value ) };
+
+        if ( ec != std::errc() || end != str.data() + str.size() )
+        {
+            return std::nullopt;
+        }
+
+        // from_chars parses "inf" and "nan", streams don't
+        if constexpr ( std::is_floating_point_v<T> )
+        {
+            if ( !std::isfinite( value ) )
+            {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Convert T to value text, floating point in shortest round-trip form
+template<FastConvertible T>
+std::string ToChars( T value )
+{
+    if constexpr ( std::is_same_v<T, bool> )
+    {
+        return value ? "true" : "false";
+    }
+    else
+    {
+        char buf[64];
+        const auto [end, ec]{ std::to_chars( buf, buf + sizeof( buf ), value ) };
+        return { buf, ec == std::errc() ? end : buf };
+    }
+}
+
+// -----------------------------------------------------------------------------
+// FastTranslator : Boost.PropertyTree translator for std::string values
+// -----------------------------------------------------------------------------
+template<FastConvertible T>
+struct FastTranslator
+{
+    using internal_type = std::string;
+    using external_type = T;
+
+    boost::optional<T> get_value( const std::string& str ) const
+    {
+        if ( const auto value{ FromChars<T>( str ) } )
+        {
+            return *value;
+        }
+        return boost::none;
+    }
+
+    boost::optional<std::string> put_value( const T& value ) const
+    {
+        return ToChars( value );
+    }
+};
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader
+
+// -----------------------------------------------------------------------------
+#ifdef PTREE_LOADER_FAST_TRANSLATOR
+namespace boost::property_tree
+{
+/// FastTranslator as the default translator of std::string based trees
+template<typename T>
+    requires ptree_loader::FastConvertible<T>
+struct translator_between<std::string, T>
+{
+    using type = ptree_loader::FastTranslator<T>;
+};
+} // namespace boost::property_tree
+#endif // PTREE_LOADER_FAST_TRANSLATOR
+
+// -----------------------------------------------------------------------------
+#endif // PtreeTranslator_H
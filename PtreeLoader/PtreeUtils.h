@@ -0,0 +1,133 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Small helpers shared by PtreeLoader components.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+#ifndef PtreeUtils_H
+#define PtreeUtils_H
+
+// -----------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <cstdio>
+#include <type_traits>
+#include <streambuf>
+
+// -----------------------------------------------------------------------------
+namespace ptree_loader::detail
+{
+
+// -----------------------------------------------------------------------------
+/// Escape a string for use inside a JSON string literal
+inline std::string JsonEscape( std::string_view str )
+{
+    std::string result;
+    result.reserve( str.size() );
+
+    for ( const char c : str )
+    {
+        switch ( c )
+        {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n";  break;
+            case '\r': result += "\\r";  break;
+            case '\t': result += "\\t";  break;
+            default:
+                if ( static_cast<unsigned char>( c ) < 0x20 )
+                {
+                    char buf[8];
+                    std::snprintf( buf, sizeof( buf ), "\\u%04x", static_cast<unsigned>( c ) );
+                    result += buf;
+                }
+                else
+                {
+                    result += c;
+                }
+        }
+    }
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+/// Escape a string for use inside a Graphviz DOT quoted string
+/// Backslash starts DOT escapes such as \N or \l, so it is doubled. Newlines
+/// become centered line breaks, other control characters spaces.
+inline std::string DotEscape( std::string_view str )
+{
+    std::string result;
+    result.reserve( str.size() );
+
+    for ( const char c : str )
+    {
+        switch ( c )
+        {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n";  break;
+            default:
+                result += static_cast<unsigned char>( c ) < 0x20 ? ' ' : c;
+        }
+    }
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+/// Pass key to a parser handler, whose Key() may return false to reject the
+/// key together with its value and subtree
+/// @return Whether the handler accepted the key
+template<typename Handler>
+bool AcceptKey( Handler& handler, std::string_view key )
+{
+    if constexpr ( std::is_same_v<decltype( handler.Key( key ) ), bool> )
+    {
+        return handler.Key( key );
+    }
+    else
+    {
+        handler.Key( key );
+        return true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Tell a parser handler that the children of an INFO #include follow, if it
+/// tracks its last child
+template<typename Handler>
+void BeginInclude( Handler& handler )
+{
+    if constexpr ( requires { handler.BeginInclude(); } )
+    {
+        handler.BeginInclude();
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Tell a parser handler that the children of an INFO #include are done
+template<typename Handler>
+void EndInclude( Handler& handler )
+{
+    if constexpr ( requires { handler.EndInclude(); } )
+    {
+        handler.EndInclude();
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Read-only stream buffer over text in memory, for readers that take a stream
+class ViewStreambuf : public std::streambuf
+{
+public:
+    explicit ViewStreambuf( std::string_view text )
+    {
+        char* begin{ const_cast<char*>( text.data() ) };
+        setg( begin, begin, begin + text.size() );
+    }
+};
+
+// -----------------------------------------------------------------------------
+}; // namespace ptree_loader::detail
+// -----------------------------------------------------------------------------
+#endif // PtreeUtils_H
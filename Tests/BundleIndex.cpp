@@ -0,0 +1,334 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Test of the tar and zip index of Bundle (PtreeBundle.h) on small archives
+// built in memory: ustar prefixes, base-256 sizes, GNU long names, pax paths,
+// zip offsets and comments, and the errors of truncated or corrupted archives.
+// Archives are written to the temporary directory.
+//
+// Usage: PtreeBundleIndex
+// Exit code is 1 if any case failed.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+
+#include <PtreeBundle.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// -----------------------------------------------------------------------------
+constexpr std::size_t blockSize{ 512 };
+
+struct Case
+{
+    const char*                                      name;
+    std::string                                      archive;
+    std::vector<std::pair<std::string, std::string>> files;  ///< Expected bundle path and content
+    const char*                                      error;  ///< Expected start of the error, null if valid
+};
+
+// -----------------------------------------------------------------------------
+// Tar
+// -----------------------------------------------------------------------------
+/// Compute and store the checksum of a tar header
+void TarChecksum( std::string& header )
+{
+    std::uint64_t sum{ 8 * ' ' };
+
+    for ( std::size_t i{ 0 }; i < blockSize; ++i )
+    {
+        sum += i >= 148 && i < 156 ? 0 : static_cast<unsigned char>( header[i] );
+    }
+    std::snprintf( header.data() + 148, 8, "%06o", static_cast<unsigned>( sum ) );
+    header[155] = ' ';
+}
+
+/// Tar header block
+/// @param base256 Store the size in base-256 instead of octal
+std::string TarHeader( const std::string& name, std::uint64_t size, char type, const std::string& prefix = {},
+                       bool base256 = false )
+{
+    std::string header( blockSize, '\0' );
+
+    header.replace( 0, name.size(), name );
+    header.replace( 100, 7, "0000644" );
+
+    if ( base256 )
+    {
+        header[124] = static_cast<char>( 0x80 );
+
+        for ( std::size_t i{ 135 }; i > 124; --i, size >>= 8 )
+        {
+            header[i] = static_cast<char>( size & 0xff );
+        }
+    }
+    else
+    {
+        std::snprintf( header.data() + 124, 12, "%011llo", static_cast<unsigned long long>( size ) );
+    }
+
+    header[156] = type;
+    header.replace( 257, 8, std::string( "ustar\0" "00", 8 ) );
+    header.replace( 345, prefix.size(), prefix );
+    TarChecksum( header );
+    return header;
+}
+
+/// Content padded to whole blocks
+std::string TarData( const std::string& content )
+{
+    return content + std::string( ( blockSize - content.size() % blockSize ) % blockSize, '\0' );
+}
+
+std::string TarEntry( const std::string& name, const std::string& content, char type = '0', const std::string& prefix = {} )
+{
+    return TarHeader( name, content.size(), type, prefix ) + TarData( content );
+}
+
+/// Pax extended header with one path record
+std::string PaxPath( const std::string& path )
+{
+    std::string record{ " path=" + path + "\n" };
+    std::size_t length{ record.size() + 1 };
+
+    // Length counts its own digits
+    while ( std::to_string( length ).size() + record.size() != length )
+    {
+        ++length;
+    }
+    record = std::to_string( length ) + record;
+    return TarEntry( "PaxHeaders/x", record, 'x' );
+}
+
+const std::string tarEnd( 2 * blockSize, '\0' );
+
+// -----------------------------------------------------------------------------
+// Zip
+// -----------------------------------------------------------------------------
+void Put16( std::string& out, std::uint32_t value )
+{
+    out += static_cast<char>( value & 0xff );
+    out += static_cast<char>( value >> 8 & 0xff );
+}
+
+void Put32( std::string& out, std::uint32_t value )
+{
+    Put16( out, value & 0xffff );
+    Put16( out, value >> 16 );
+}
+
+struct ZipEntry
+{
+    std::string   name;
+    std::string   content;
+    std::uint32_t method{ 0 };  ///< 0 stored, 8 deflated
+    std::string   extra;        ///< Extra field of the local header
+};
+
+/// Zip archive of entries
+/// @param cdShift Added to the central directory offset of the end record
+/// @param localShift Added to the local header offset of the first entry
+/// @param sizeShift Added to the size of the first entry in the central directory
+std::string Zip( const std::vector<ZipEntry>& entries, const std::string& comment = {}, std::uint32_t cdShift = 0,
+                 std::uint32_t localShift = 0, std::uint32_t sizeShift = 0 )
+{
+    std::string archive;
+    std::string directory;
+
+    for ( const ZipEntry& entry : entries )
+    {
+        const auto        size{ static_cast<std::uint32_t>( entry.content.size() ) };
+        const std::size_t local{ archive.size() };
+
+        Put32( archive, 0x04034b50 );
+        Put16( archive, 20 );
+        Put16( archive, 0 );
+        Put16( archive, entry.method );
+        Put32( archive, 0 );  // Time and date
+        Put32( archive, 0 );  // CRC-32, not checked
+        Put32( archive, size );
+        Put32( archive, size );
+        Put16( archive, static_cast<std::uint32_t>( entry.name.size() ) );
+        Put16( archive, static_cast<std::uint32_t>( entry.extra.size() ) );
+        archive += entry.name + entry.extra + entry.content;
+
+        const bool first{ directory.empty() };
+
+        Put32( directory, 0x02014b50 );
+        Put16( directory, 20 );
+        Put16( directory, 20 );
+        Put16( directory, 0 );
+        Put16( directory, entry.method );
+        Put32( directory, 0 );
+        Put32( directory, 0 );
+        Put32( directory, size + ( first ? sizeShift : 0 ) );
+        Put32( directory, size );
+        Put16( directory, static_cast<std::uint32_t>( entry.name.size() ) );
+        Put16( directory, 0 );
+        Put16( directory, 0 );
+        Put16( directory, 0 );
+        Put16( directory, 0 );
+        Put32( directory, 0 );
+        Put32( directory, static_cast<std::uint32_t>( local ) + ( first ? localShift : 0 ) );
+        directory += entry.name;
+    }
+
+    const auto directoryOffset{ static_cast<std::uint32_t>( archive.size() ) };
+
+    archive += directory;
+    Put32( archive, 0x06054b50 );
+    Put16( archive, 0 );
+    Put16( archive, 0 );
+    Put16( archive, static_cast<std::uint32_t>( entries.size() ) );
+    Put16( archive, static_cast<std::uint32_t>( entries.size() ) );
+    Put32( archive, static_cast<std::uint32_t>( directory.size() ) );
+    Put32( archive, directoryOffset + cdShift );
+    Put16( archive, static_cast<std::uint32_t>( comment.size() ) );
+    return archive + comment;
+}
+
+// -----------------------------------------------------------------------------
+/// Tar header with a corrupted checksum
+std::string BadChecksum()
+{
+    std::string header{ TarHeader( "a.info", 0, '0' ) };
+    header[148] = '7';
+    return header + tarEnd;
+}
+
+// -----------------------------------------------------------------------------
+const std::string longName{ std::string( 120, 'l' ) + ".info" };
+const std::string paxName{ "pax/" + std::string( 150, 'p' ) + ".info" };
+const std::string bigContent( 3 * blockSize + 7, 'x' );
+
+const std::vector<Case> cases{
+    { "tar plain",
+      TarEntry( "./conf/a.info", "a 1\n" ) + TarEntry( "conf/", "", '5' ) + TarEntry( "b.json", "{}" ) + tarEnd,
+      { { "/conf/a.info", "a 1\n" }, { "/b.json", "{}" } }, nullptr },
+    { "tar without end blocks",
+      TarEntry( "a.info", "a 1\n" ),
+      { { "/a.info", "a 1\n" } }, nullptr },
+    { "tar ustar prefix",
+      TarEntry( "c.info", "c 3\n", '0', "deep/dir" ) + tarEnd,
+      { { "/deep/dir/c.info", "c 3\n" } }, nullptr },
+    { "tar base-256 size",
+      TarHeader( "big.info", bigContent.size(), '0', {}, true ) + TarData( bigContent ) + TarEntry( "after.info", "z" ) + tarEnd,
+      { { "/big.info", bigContent }, { "/after.info", "z" } }, nullptr },
+    { "tar GNU long name",
+      TarEntry( "././@LongLink", longName + '\0', 'L' ) + TarEntry( longName.substr( 0, 99 ), "l 1\n" ) +
+          TarEntry( "short.info", "s 1\n" ) + tarEnd,
+      { { "/" + longName, "l 1\n" }, { "/short.info", "s 1\n" } }, nullptr },
+    { "tar pax path",
+      PaxPath( paxName ) + TarEntry( "truncated.info", "p 1\n" ) + tarEnd,
+      { { "/" + paxName, "p 1\n" } }, nullptr },
+    { "tar links ignored",
+      TarEntry( "link.info", "", '2' ) + TarEntry( "a.info", "a" ) + tarEnd,
+      { { "/a.info", "a" } }, nullptr },
+    { "tar error checksum",
+      BadChecksum(), {}, "invalid tar header at offset 0" },
+    { "tar error size field",
+      [] { std::string h{ TarHeader( "a.info", 0, '0' ) }; h[130] = '9'; TarChecksum( h ); return h + tarEnd; }(),
+      {}, "invalid tar header at offset 0" },
+    { "tar error truncated header",
+      TarEntry( "a.info", "a" ) + std::string( 100, 'h' ), {}, "truncated tar archive" },
+    { "tar error truncated entry",
+      TarHeader( "a.info", 2 * blockSize, '0' ) + TarData( "a" ), {}, "truncated tar entry at offset 0" },
+    { "tar error pax record",
+      TarEntry( "PaxHeaders/x", "99 path=x\n", 'x' ) + tarEnd, {}, "invalid pax header at offset 512" },
+    { "zip stored",
+      Zip( { { "conf/", "" }, { "conf/a.info", "a 1\n", 0, "extra" }, { "b.json", "{}" } } ),
+      { { "/conf/a.info", "a 1\n" }, { "/b.json", "{}" } }, nullptr },
+    { "zip comment",
+      Zip( { { "a.info", "a 1\n" } }, "PK\x05\x06 is not an end record in a comment" ),
+      { { "/a.info", "a 1\n" } }, nullptr },
+    { "zip error compressed",
+      Zip( { { "a.info", "a 1\n", 8 } } ), {}, "compressed zip entry a.info" },
+    { "zip error directory offset",
+      Zip( { { "a.info", "a 1\n" } }, {}, 3 ), {}, "invalid zip central directory entry 0" },
+    { "zip error local offset",
+      Zip( { { "a.info", "a 1\n" } }, {}, 0, 1 ), {}, "invalid zip local header of a.info" },
+    { "zip error truncated entry",
+      Zip( { { "a.info", "a 1\n" } }, {}, 0, 0, 1000 ), {}, "truncated zip entry a.info" },
+    { "zip error no end record",
+      Zip( { { "a.info", "a 1\n" } } ).substr( 0, 60 ), {}, "zip central directory not found" },
+};
+
+// -----------------------------------------------------------------------------
+/// Open the archive of a case
+/// @return false and a report on std::cout if the result is not the expected one
+bool Check( const Case& test )
+{
+    const fs::path archive{ fs::temp_directory_path() / "PtreeBundleIndex.bin" };
+
+    std::ofstream( archive, std::ios::binary ) << test.archive;
+
+    const auto bundle{ ptree_loader::Bundle::Open( archive ) };
+
+    fs::remove( archive );
+
+    if ( test.error )
+    {
+        if ( bundle )
+        {
+            std::cout << "FAILED: " << test.name << ": opened, expected " << test.error << '\n';
+            return false;
+        }
+        if ( !bundle.error().starts_with( test.error ) )
+        {
+            std::cout << "FAILED: " << test.name << ": " << bundle.error() << ", expected " << test.error << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    if ( !bundle )
+    {
+        std::cout << "FAILED: " << test.name << ": " << bundle.error() << '\n';
+        return false;
+    }
+
+    bool ok{ bundle->Size() == test.files.size() };
+
+    for ( const auto& [path, content] : test.files )
+    {
+        const auto found{ bundle->Find( path ) };
+
+        if ( !found || *found != content )
+        {
+            std::cout << "FAILED: " << test.name << ": " << path << ( found ? " differs" : " not found" ) << '\n';
+            ok = false;
+        }
+    }
+
+    if ( bundle->Size() != test.files.size() )
+    {
+        std::cout << "FAILED: " << test.name << ": " << bundle->Size() << " files, expected " << test.files.size() << '\n';
+    }
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+// main()
+// -----------------------------------------------------------------------------
+int main()
+{
+    std::size_t failed{ 0 };
+
+    for ( const Case& test : cases )
+    {
+        failed += !Check( test );
+    }
+
+    std::cout << "Checked " << cases.size() << " archives, " << failed << " failed\n";
+
+    return failed ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
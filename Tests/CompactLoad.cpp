@@ -0,0 +1,154 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Test of PtreeLoader::LoadCompact() with packed arrays: every file must give
+// the expected tree, packed or not.
+// Files are held in a MemoryFileSystem, expected trees are INFO text.
+//
+// Usage: PtreeCompactLoad
+// Exit code is 1 if any case failed.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+
+#include <PtreeLoader.h>
+#include <boost/property_tree/info_parser.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bpt = boost::property_tree;
+
+using JsonLoader = ptree_loader::PtreeLoader<ptree_loader::PtreeFileFormat::json>;
+using InfoLoader = ptree_loader::PtreeLoader<ptree_loader::PtreeFileFormat::info>;
+
+// -----------------------------------------------------------------------------
+struct Case
+{
+    const char* name;
+    const char* root;
+    const char* expected;
+};
+
+// -----------------------------------------------------------------------------
+const std::vector<Case> cases{
+    { "root array",          "/table.json",  "\"\" 1\n\"\" 2\n\"\" 3\n\"\" 4\n" },
+    { "included root array", "/main.json",   "IncludeFile table.json\n\"\" 1\n\"\" 2\n\"\" 3\n\"\" 4\nx 1\n" },
+    { "nested array",        "/nested.json", "a { b { \"\" 1.5\n\"\" 2\n\"\" -3 } }\nc { \"\" 7\n\"\" 8 }\n" },
+    { "element text",        "/text.json",   "a { \"\" 007\n\"\" 1.50\n\"\" -0\n\"\" 1e3\n\"\" 99999999999999999999 }\n" },
+};
+
+const std::vector<Case> infoCases{
+    { "info include subtree", "/main.info",   "a { c 2 }\nb 1\n" },
+};
+
+// -----------------------------------------------------------------------------
+/// Add the files of all cases
+void AddFiles( ptree_loader::MemoryFileSystem& files )
+{
+    files.Add( "/table.json",  "[1, 2, 3, 4]" );
+    files.Add( "/main.json",   "{ \"IncludeFile\": \"table.json\", \"x\": 1 }" );
+    files.Add( "/nested.json", "{ \"a\": { \"b\": [1.5, 2, -3] }, \"c\": [7, 8] }" );
+    files.Add( "/text.json",   "{ \"a\": [\"007\", \"1.50\", -0, 1e3, 99999999999999999999] }" );
+    files.Add( "/main.info",   "a\n#include \"b.info\"\n{\n    c 2\n}\n" );
+    files.Add( "/b.info",      "b 1\n" );
+    files.Add( "/spaces.json", "{ \"a\": \" true\", \"b\": \" 12 \" }" );
+}
+
+// -----------------------------------------------------------------------------
+/// Compare LoadCompact() with packed arrays to the expected tree
+/// @return false and a report on std::cout if they differ
+template<typename Loader>
+bool Check( const Case& test, const ptree_loader::MemoryFileSystem& files )
+{
+    bpt::ptree         expected;
+    std::istringstream expectedText( test.expected );
+
+    bpt::read_info( expectedText, expected );
+
+    bpt::ptree                unused;
+    Loader                    compactLoader( unused );
+    ptree_loader::CompactTree tree;
+
+    compactLoader.SetFileSystem( &files );
+    compactLoader.SetPackArrays( 2 );
+
+    if ( !compactLoader.LoadCompact( test.root, tree ) )
+    {
+        std::cout << "FAILED: " << test.name << ": LoadCompact() failed\n";
+        return false;
+    }
+
+    const bpt::ptree actual{ tree.Root().ToPtree() };
+
+    if ( actual != expected )
+    {
+        std::ostringstream loadDump;
+        std::ostringstream compactDump;
+
+        bpt::write_info( loadDump, expected );
+        bpt::write_info( compactDump, actual );
+        std::cout << "FAILED: " << test.name << ": trees differ\n--- expected\n"
+                  << loadDump.str() << "--- LoadCompact\n" << compactDump.str();
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// main()
+// -----------------------------------------------------------------------------
+int main()
+{
+    ptree_loader::MemoryFileSystem files;
+    std::size_t                    failed{ 0 };
+
+    AddFiles( files );
+
+    for ( const Case& test : cases )
+    {
+        failed += !Check<JsonLoader>( test, files );
+    }
+
+    for ( const Case& test : infoCases )
+    {
+        failed += !Check<InfoLoader>( test, files );
+    }
+
+    // Nested arrays are packed, whatever the text of their elements
+    bpt::ptree                unused;
+    JsonLoader                loader( unused );
+    ptree_loader::CompactTree tree;
+    ptree_loader::CompactTree textTree;
+
+    loader.SetFileSystem( &files );
+    loader.SetPackArrays( 2 );
+    loader.LoadCompact( "/nested.json", tree );
+    loader.LoadCompact( "/text.json", textTree );
+
+    if ( tree.Find( "a.b" )->Reals().size() != 3 || tree.Find( "c" )->Integers().size() != 2 ||
+         textTree.Find( "a" )->Reals().size() != 5 )
+    {
+        std::cout << "FAILED: nested arrays are not packed\n";
+        ++failed;
+    }
+
+    // Typed scalars convert as FromChars(), spaces included
+    ptree_loader::CompactTree typedTree;
+
+    loader.SetTypedScalars( true );
+    loader.LoadCompact( "/spaces.json", typedTree );
+
+    if ( typedTree.Find( "a" )->GetValue<bool>() != true || typedTree.Find( "b" )->GetValue<int>() != 12 )
+    {
+        std::cout << "FAILED: typed scalars differ from FromChars()\n";
+        ++failed;
+    }
+
+    std::cout << "Checked " << cases.size() + infoCases.size() + 2 << " cases, " << failed << " failed\n";
+
+    return failed ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,213 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Parity test of the native INFO and JSON parsers (PtreeParsers.h) with
+// read_info()/read_json(): valid input must give identical ptrees, invalid
+// input must be rejected by both.
+// Inputs are the Example files and edge cases: BOM, CRLF, continuation lines,
+// escapes, surrogate pairs, #include and errors.
+//
+// Usage: PtreeParserParity <Example/Ptrees directory>
+// Exit code is 1 if any case failed.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+
+#include <PtreeParsers.h>
+#include <boost/property_tree/info_parser.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bpt = boost::property_tree;
+
+// -----------------------------------------------------------------------------
+enum class Format { info, json };
+
+struct Case
+{
+    const char* name;
+    Format      format;
+    std::string text;
+};
+
+// -----------------------------------------------------------------------------
+const std::vector<Case> edgeCases{
+    { "info plain",               Format::info, "a 1\nb\n{\n    c 2\n}\n" },
+    { "info BOM",                 Format::info, "\xEF\xBB\xBF" "a 1\n" },
+    { "info CRLF",                Format::info, "a 1\r\nb\r\n{\r\n    c \"x y\"\r\n}\r\n" },
+    { "info continuation",        Format::info, "a \"first\" \\\n  \"second\" \\\n  \"third\"\nb 2\n" },
+    { "info escapes",             Format::info, "a \"tab\\tquote\\\"back\\\\slash\\nline\\0\"\n" },
+    { "info comments",            Format::info, "; comment\na 1 ; trailing\n\"quoted key\" \"quoted value\"\n" },
+    { "info duplicates",          Format::info, "a 1\na 2\na\n{\n    a 3\n}\n" },
+    { "info empty",               Format::info, "" },
+    { "info inline braces",       Format::info, "a { b 1 }\n" },
+    { "info error brace",         Format::info, "a\n{\n    b 1\n" },
+    { "info error close",         Format::info, "a 1\n}\n" },
+    { "info error string",        Format::info, "a \"unterminated\n" },
+    { "info error escape",        Format::info, "a \"bad\\q\"\n" },
+    { "info error directive",     Format::info, "#define a\n" },
+    { "json plain",               Format::json, "{ \"a\": 1, \"b\": { \"c\": [1, 2, 3] } }" },
+    { "json BOM",                 Format::json, "\xEF\xBB\xBF" "{ \"a\": 1 }" },
+    { "json CRLF",                Format::json, "{\r\n  \"a\": \"x\",\r\n  \"b\": [true, false, null]\r\n}\r\n" },
+    { "json escapes",             Format::json, "{ \"a\": \"q\\\" b\\\\ s\\/ \\b\\f\\n\\r\\t \\u00e9\\u20AC\" }" },
+    { "json surrogate pair",      Format::json, "{ \"a\": \"\\ud83d\\ude00\" }" },
+    { "json numbers",             Format::json, "{ \"a\": -0.5e+10, \"b\": 0, \"c\": 1E3 }" },
+    { "json duplicates",          Format::json, "{ \"a\": 1, \"a\": 2 }" },
+    { "json nested arrays",       Format::json, "[[1, [2]], {\"a\": []}, {}]" },
+    { "json error BOM prefix",    Format::json, "\xEF\xBB{ \"a\": 1 }" },
+    { "json error trailing",      Format::json, "{ \"a\": 1 } x" },
+    { "json error leading zero",  Format::json, "{ \"a\": 007 }" },
+    { "json error comma",         Format::json, "{ \"a\": 1, }" },
+    { "json error lone surrogate",Format::json, "{ \"a\": \"\\ud83d\" }" },
+    { "json error unterminated",  Format::json, "{ \"a\": \"x" },
+    { "json error empty",         Format::json, "" },
+};
+
+// -----------------------------------------------------------------------------
+/// Boost parse of text
+/// @return false if Boost rejects it
+bool BoostParse( Format format, const std::string& text, bpt::ptree& pt )
+{
+    std::istringstream stream( text );
+
+    try
+    {
+        if ( format == Format::info )
+        {
+            bpt::read_info( stream, pt );
+        }
+        else
+        {
+            bpt::read_json( stream, pt );
+        }
+        return true;
+    }
+    catch ( const bpt::file_parser_error& )
+    {
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Native parse of text
+/// @return false if the native parser rejects it
+bool NativeParse( Format format, const std::string& text, bpt::ptree& pt, std::vector<ptree_loader::ParseError>& errors )
+{
+    ptree_loader::PtreeBuilder builder( pt );
+
+    return format == Format::info ? ptree_loader::ParseInfo( text, "test", builder, errors )
+                                  : ptree_loader::ParseJson( text, "test", builder, errors );
+}
+
+// -----------------------------------------------------------------------------
+/// Compare both parsers on text
+/// @return false and a report on std::cout if they disagree
+bool Check( const std::string& name, Format format, const std::string& text )
+{
+    bpt::ptree                            expected;
+    bpt::ptree                            actual;
+    std::vector<ptree_loader::ParseError> errors;
+
+    const bool boostValid{ BoostParse( format, text, expected ) };
+    const bool nativeValid{ NativeParse( format, text, actual, errors ) };
+
+    if ( boostValid != nativeValid )
+    {
+        std::cout << "FAILED: " << name << ": Boost " << ( boostValid ? "accepts" : "rejects" ) << ", native "
+                  << ( nativeValid ? "accepts" : "rejects" ) << '\n';
+
+        for ( const auto& error : errors )
+        {
+            std::cout << "    " << error.ToString() << '\n';
+        }
+        return false;
+    }
+
+    if ( boostValid && expected != actual )
+    {
+        std::ostringstream boostDump;
+        std::ostringstream nativeDump;
+
+        bpt::write_info( boostDump, expected );
+        bpt::write_info( nativeDump, actual );
+        std::cout << "FAILED: " << name << ": ptrees differ\n--- Boost\n"
+                  << boostDump.str() << "--- native\n" << nativeDump.str();
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// main()
+// -----------------------------------------------------------------------------
+int main( int argc, char *argv[] )
+{
+    if ( argc < 2 )
+    {
+        std::cout << "Usage: PtreeParserParity <Example/Ptrees directory>\n";
+        return 1;
+    }
+
+    std::size_t checked{ 0 };
+    std::size_t failed{ 0 };
+
+    for ( const auto& entry : std::filesystem::recursive_directory_iterator( argv[1] ) )
+    {
+        const std::string ext{ entry.path().extension().string() };
+
+        if ( ext != ".info" && ext != ".json" )
+        {
+            continue;
+        }
+
+        std::string text;
+
+        if ( !ptree_loader::detail::ReadFile( entry.path().string(), text ) )
+        {
+            std::cout << "FAILED: cannot read " << entry.path().string() << '\n';
+            ++failed;
+            continue;
+        }
+
+        ++checked;
+        failed += !Check( entry.path().string(), ext == ".info" ? Format::info : Format::json, text );
+    }
+
+    for ( const Case& test : edgeCases )
+    {
+        ++checked;
+        failed += !Check( test.name, test.format, test.text );
+    }
+
+    // Both parsers read #include files relative to the working directory
+    const std::filesystem::path included{ std::filesystem::temp_directory_path() / "PtreeParserParity.info" };
+    const std::string           directive{ "#include \"" + included.generic_string() + "\"\n" };
+
+    std::ofstream( included ) << "b 1\n";
+
+    const std::vector<Case> includeCases{
+        { "info include",             Format::info, "a 1\n" + directive + "c 2\n" },
+        { "info include subtree",     Format::info, "a\n" + directive + "{\n    c 2\n}\n" },
+        { "info include nested",      Format::info, "a\n{\n    " + directive + "    c 2\n}\n" },
+        { "info error include",       Format::info, "#include \"missing.info\"\n" },
+    };
+
+    for ( const Case& test : includeCases )
+    {
+        ++checked;
+        failed += !Check( test.name, test.format, test.text );
+    }
+
+    std::filesystem::remove( included );
+
+    std::cout << "Checked " << checked << " inputs, " << failed << " failed\n";
+
+    return failed ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
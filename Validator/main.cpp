@@ -0,0 +1,171 @@
+// =============================================================================
+// Ptree Loader
+// =============================================================================
+// Batch validator: loads many root files with PtreeLoader::TryLoad() on all
+// cores and reports errors per root.
+// Loaders share one LoadCache, so fragments included by many roots are
+// resolved and parsed once.
+//
+// Usage: PtreeValidator [-j <threads>] [-l <list file>] [-v] [<root file>...]
+//   -j  number of worker threads (default: hardware concurrency)
+//   -l  file with one root path per line
+//   -v  report successful roots too
+// Exit code is 1 if any root failed to validate.
+//
+// @author Dwoggurd (2024)
+// =============================================================================
+
+#include <print>
+#include <PtreeLoader.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+// -----------------------------------------------------------------------------
+template<ptree_loader::PtreeFileFormat T>
+ptree_loader::LoadResult ValidateRoot( const std::filesystem::path &fsPath, ptree_loader::LoadCache &cache )
+{
+    boost::property_tree::ptree pt;
+    ptree_loader::PtreeLoader<T> ptLoader( pt );
+
+    ptLoader.SetCache( &cache );
+    return ptLoader.TryLoad( fsPath );
+}
+
+// -----------------------------------------------------------------------------
+ptree_loader::LoadResult Validate( const std::filesystem::path &fsPath, ptree_loader::LoadCache &cache )
+{
+    const std::string ext{ fsPath.extension().string() };
+
+    if ( ext == ".xml" )
+    {
+        return ValidateRoot<ptree_loader::PtreeFileFormat::xml>( fsPath, cache );
+    }
+    else if ( ext == ".json" )
+    {
+        return ValidateRoot<ptree_loader::PtreeFileFormat::json>( fsPath, cache );
+    }
+    else if ( ext == ".info" )
+    {
+        return ValidateRoot<ptree_loader::PtreeFileFormat::info>( fsPath, cache );
+    }
+
+    return std::unexpected( std::vector<ptree_loader::ParseError>{
+        { fsPath.string(), 0, 0, "unknown file format" } } );
+}
+
+// -----------------------------------------------------------------------------
+// main()
+// -----------------------------------------------------------------------------
+int main( int argc, char *argv[] )
+{
+    std::vector<std::filesystem::path> roots;
+    unsigned                           threads{ std::max( 1u, std::thread::hardware_concurrency() ) };
+    bool                               verbose{ false };
+
+    for ( int i{ 1 }; i < argc; ++i )
+    {
+        const std::string arg{ argv[i] };
+
+        if ( arg == "-j" && i + 1 < argc )
+        {
+            threads = std::max( 1, std::atoi( argv[++i] ) );
+        }
+        else if ( arg == "-l" && i + 1 < argc )
+        {
+            std::ifstream list( argv[++i] );
+
+            for ( std::string line; std::getline( list, line ); )
+            {
+                if ( !line.empty() && line.back() == '\r' )
+                {
+                    line.pop_back();
+                }
+                if ( !line.empty() )
+                {
+                    roots.emplace_back( line );
+                }
+            }
+        }
+        else if ( arg == "-v" )
+        {
+            verbose = true;
+        }
+        else
+        {
+            roots.emplace_back( arg );
+        }
+    }
+
+    if ( roots.empty() )
+    {
+        std::print( "Usage: PtreeValidator [-j <threads>] [-l <list file>] [-v] [<root file>...]\n" );
+        return 0;
+    }
+
+    const auto start{ std::chrono::steady_clock::now() };
+
+    ptree_loader::LoadCache               cache;
+    std::vector<ptree_loader::LoadResult> results( roots.size() );
+    std::atomic<std::size_t>              next{ 0 };
+
+    {
+        std::vector<std::jthread> workers;
+
+        for ( unsigned t{ 0 }; t < std::min<std::size_t>( threads, roots.size() ); ++t )
+        {
+            workers.emplace_back( [&]()
+            {
+                for ( std::size_t i; ( i = next++ ) < roots.size(); )
+                {
+                    // An exception fails its root only, not the whole run
+                    try
+                    {
+                        results[i] = Validate( roots[i], cache );
+                    }
+                    catch ( const std::exception& e )
+                    {
+                        results[i] = std::unexpected( std::vector<ptree_loader::ParseError>{
+                            { roots[i].string(), 0, 0, e.what() } } );
+                    }
+                }
+            } );
+        }
+    }
+
+    // Report in input order
+    std::size_t failed{ 0 };
+
+    for ( std::size_t i{ 0 }; i < roots.size(); ++i )
+    {
+        if ( results[i] )
+        {
+            if ( verbose )
+            {
+                std::print( "OK: {}\n", roots[i].string() );
+            }
+            continue;
+        }
+
+        ++failed;
+        std::print( "FAILED: {}\n", roots[i].string() );
+
+        for ( const auto& error : results[i].error() )
+        {
+            std::print( "    {}\n", error.ToString() );
+        }
+    }
+
+    const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+    std::print( "Validated {} roots, {} failed, {:.3f} s\n", roots.size(), failed, elapsed.count() );
+
+    return failed ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------